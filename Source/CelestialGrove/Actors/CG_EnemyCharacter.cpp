@@ -6,25 +6,34 @@
 #include "CG_EnemyCharacter.h"
 #include "CG_PlayerCharacter.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/WidgetComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_RagdollSubsystem.h"
+#include "CG_HealthBarSubsystem.h"
+#include "CG_StatusSubsystem.h"
+#include "CG_CombatStateSubsystem.h"
+#include "CG_SessionRecorderSubsystem.h"
+#include "CG_Profiling.h"
 
 // -----------------------------------------------------------------------------------------
 ACG_EnemyCharacter::ACG_EnemyCharacter()
 {
 	// ============================================================
 	// Tick settings
-	// TODO(RyanC): Disable tick for all enemies until they are within an acceptable distance of the player.
+	// NOTE(RyanC): The significance subsystem decides if and how often enemies tick once they're in play.
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.bStartWithTickEnabled = true;
 
-	// ============================================================
-	// Component Initialization
-	Health = CreateDefaultSubobject<UWidgetComponent>(TEXT("Health"));
-	Health->SetupAttachment(RootComponent);
-
-	RagdollSettleTolerance = 0.5f;
+	HealthBarHeight = 20.0f;
+	RagdollSettleSpeed = 30.0f;
 	PushByForceResistance = 150.f;
 	IsInRagdoll = false;
+
+	SignificanceSubsystem = nullptr;
+	HealthBars = nullptr;
+	CombatState = nullptr;
+	CombatId = INDEX_NONE;
+	Significance = ESignificance::NEAR;
 }
 
 // -----------------------------------------------------------------------------------------
@@ -36,80 +45,165 @@ void ACG_EnemyCharacter::BeginPlay()
 	Target.ApplyDamageDelegate.AddUObject(this, &ACG_EnemyCharacter::ApplyDamage);
 	Target.ApplyStatusDelegate.AddUObject(this, &ACG_EnemyCharacter::ApplyStatus);
 	Target.ApplyForceDelegate.AddUObject(this, &ACG_EnemyCharacter::ApplyForce);
+
+	TargetHandle = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>()->RegisterTarget(this, &Target, ESpellTargetKind::ANIMATE, GetMesh());
+
+	CombatState = GetWorld()->GetSubsystem<UCG_CombatStateSubsystem>();
+	check(CombatState);
+	CombatId = CombatState->RegisterCombatant(TargetHandle, Stats, FCG_CombatEventDelegate::CreateUObject(this, &ACG_EnemyCharacter::OnCombatEvent));
+
+	HealthBars = GetWorld()->GetSubsystem<UCG_HealthBarSubsystem>();
+	check(HealthBars);
+
+	SignificanceSubsystem = GetWorld()->GetSubsystem<UCG_SignificanceSubsystem>();
+	check(SignificanceSubsystem);
+	SignificanceSubsystem->RegisterEnemy(this);
+
+	RagdollBone = GetMesh()->GetSocketBoneName(RagdollSocketToFollow);
+
+	UCG_SessionRecorderSubsystem * recorder = GetWorld()->GetSubsystem<UCG_SessionRecorderSubsystem>();
+	if (recorder)
+	{
+		recorder->RecordEnemySpawn(this);
+	}
 }
 
 // -----------------------------------------------------------------------------------------
-void ACG_EnemyCharacter::Tick(float deltaTime)
+void ACG_EnemyCharacter::EndPlay(const EEndPlayReason::Type endPlayReason)
 {
-	Super::Tick(deltaTime);
+	if (CombatState)
+	{
+		CombatState->UnregisterCombatant(CombatId);
+		CombatState = nullptr;
+		CombatId = INDEX_NONE;
+	}
 
-	if (IsInRagdoll)
+	UCG_TargetRegistrySubsystem * registry = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	if (registry)
 	{
-		// ============================================================
-		// Keep moving the root to the ragdolling mesh so the health bar stays with it
-		FVector socketLocation = GetMesh()->GetSocketLocation(RagdollSocketToFollow);
-		RootComponent->SetWorldLocation(socketLocation + CapsuleToMeshOffset);
-
-		// ============================================================
-		// Now we check to see if we have already settled using the defined tolerance
-		FVector currentPosition = GetMesh()->GetComponentLocation();
-		FVector positionDelta = currentPosition - PreviousMeshPosition;
-		float length = positionDelta.Length();
-		if (length < RagdollSettleTolerance)
-		{
-			IsInRagdoll = false;
-			// We are now settled turn off simulation and call into blueprints to start get up animation
-			GetMesh()->SetSimulatePhysics(false);
-			GetMesh()->PutAllRigidBodiesToSleep();
+		registry->UnregisterTarget(this);
+	}
 
-			OnBeginStandUp();
-		}
+	UCG_RagdollSubsystem * ragdolls = GetWorld()->GetSubsystem<UCG_RagdollSubsystem>();
+	if (ragdolls)
+	{
+		ragdolls->RemoveRagdoll(this);
+	}
 
-		PreviousMeshPosition = GetMesh()->GetComponentLocation();
+	if (HealthBars)
+	{
+		HealthBars->HideBar(this);
+		HealthBars = nullptr;
+	}
+
+	if (SignificanceSubsystem)
+	{
+		SignificanceSubsystem->UnregisterEnemy(this);
+		SignificanceSubsystem = nullptr;
 	}
+
+	Super::EndPlay(endPlayReason);
 }
 
 // -----------------------------------------------------------------------------------------
 void ACG_EnemyCharacter::ApplyDamage(int32 damage)
 {
-	Stats.Health = FMath::Clamp(Stats.Health - damage, 0, Stats.Health);
+	CombatState->ApplyDamage(CombatId, damage);
+}
 
-	if (Stats.Health <= 0)
+// -----------------------------------------------------------------------------------------
+void ACG_EnemyCharacter::ApplyStatus(uint8 status)
+{
+	GetWorld()->GetSubsystem<UCG_StatusSubsystem>()->ApplyStatus(TargetHandle, status);
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_EnemyCharacter::OnCombatEvent(ECombatEvent event, int32 health, uint8 status)
+{
+	Stats.Health = health;
+	Stats.Status = status;
+
+	switch (event)
 	{
-		OnDeath();
+		case ECombatEvent::DAMAGED:
+		{
+			HealthBars->SetBarHealth(this, GetHealthFraction());
+
+			CG_SCOPE_BLUEPRINT_EVENT(Enemy, OnDamaged);
+			OnDamaged();
+		}
+		break;
+
+		case ECombatEvent::DIED:
+		{
+			HealthBars->SetBarHealth(this, GetHealthFraction());
+
+			CG_SCOPE_BLUEPRINT_EVENT(Enemy, OnDeath);
+			OnDeath();
+		}
+		break;
+
+		default:
+			break;
 	}
-	else
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_EnemyCharacter::ApplyForce(FVector direction, float strength)
+{
+	if (PushByForceResistance <= strength)
 	{
-		OnDamaged();
+		UCG_RagdollSubsystem * ragdolls = GetWorld()->GetSubsystem<UCG_RagdollSubsystem>();
+		check(ragdolls);
+
+		if (ragdolls->AddRagdoll(this))
+		{
+			// Apply in blueprints in case more set up is needed for the specific enemy.
+			CG_SCOPE_BLUEPRINT_EVENT(Enemy, OnApplyForce);
+			OnApplyForce(direction * strength * GetMesh()->GetMass());
+		}
+		else
+		{
+			// NOTE(RyanC): Too many ragdolls that matter more than us, get shoved instead of falling over.
+			LaunchCharacter(direction * strength, false, false);
+		}
 	}
 }
 
 // -----------------------------------------------------------------------------------------
-void ACG_EnemyCharacter::ApplyStatus(uint8 status)
+void ACG_EnemyCharacter::EnterRagdoll()
 {
-	SET_FLAG(Stats.Status, status);
+	IsInRagdoll = true;
 
-	// TODO(RyanC): Need to figure out how statuses will work first.
+	// Detach mesh to prepare for force being applied
+	GetMesh()->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	GetMesh()->SetSimulatePhysics(true);
+	GetMesh()->WakeAllRigidBodies();
+	ApplySignificance();
+
+	CapsuleToMeshOffset = GetCapsuleComponent()->GetComponentLocation() - GetMesh()->GetComponentLocation();
 }
 
 // -----------------------------------------------------------------------------------------
-void ACG_EnemyCharacter::ApplyForce(FVector direction, float strength)
+void ACG_EnemyCharacter::ExitRagdoll()
 {
-	if (PushByForceResistance <= strength)
-	{
-		IsInRagdoll = true;
-		PreviousMeshPosition = FVector::ZeroVector;
+	IsInRagdoll = false;
 
-		// Detach mesh to prepare for force being applied
-		GetMesh()->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
-		GetMesh()->SetSimulatePhysics(true);
-		GetMesh()->WakeAllRigidBodies();
+	// We are now settled turn off simulation and call into blueprints to start get up animation
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->PutAllRigidBodiesToSleep();
+	ApplySignificance();
 
-		CapsuleToMeshOffset = GetCapsuleComponent()->GetComponentLocation() - GetMesh()->GetComponentLocation();
+	CG_SCOPE_BLUEPRINT_EVENT(Enemy, OnBeginStandUp);
+	OnBeginStandUp();
+}
 
-		// Apply in blueprints in case more set up is needed for the specific enemy.
-		OnApplyForce(direction * strength * GetMesh()->GetMass());
-	}
+// -----------------------------------------------------------------------------------------
+void ACG_EnemyCharacter::FollowRagdoll()
+{
+	// Keep moving the root to the ragdolling mesh so the health bar stays with it
+	FVector socketLocation = GetMesh()->GetSocketLocation(RagdollSocketToFollow);
+	RootComponent->SetWorldLocation(socketLocation + CapsuleToMeshOffset);
 }
 
 // -----------------------------------------------------------------------------------------
@@ -134,3 +228,52 @@ void ACG_EnemyCharacter::OnFinishedStandingUp()
 	GetMesh()->SetRelativeLocation(-CapsuleToMeshOffset);
 	GetMesh()->SetRelativeRotation(FRotator::ZeroRotator);
 }
+
+// -----------------------------------------------------------------------------------------
+void ACG_EnemyCharacter::SetSignificance(ESignificance significance)
+{
+	Significance = significance;
+	ApplySignificance();
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_EnemyCharacter::ApplySignificance()
+{
+	// NOTE(RyanC): Everything that changes how the enemy ticks goes through here. A simulating mesh
+	// still needs its tick to pull the bones back from physics so a ragdoll is never allowed to go dormant.
+	ESignificance effective = Significance;
+	if (IsInRagdoll && effective == ESignificance::DORMANT)
+	{
+		effective = ESignificance::FAR;
+	}
+
+	const bool shouldTick = (effective != ESignificance::DORMANT);
+	const float interval = SignificanceSubsystem ? SignificanceSubsystem->GetTickInterval(effective) : 0.0f;
+
+	SetActorTickEnabled(shouldTick);
+	SetActorTickInterval(interval);
+
+	UCharacterMovementComponent * movement = GetCharacterMovement();
+	movement->SetComponentTickEnabled(shouldTick);
+	movement->SetComponentTickInterval(interval);
+
+	USkeletalMeshComponent * mesh = GetMesh();
+	mesh->SetComponentTickEnabled(shouldTick);
+	mesh->SetComponentTickInterval(interval);
+
+	// Health bars are only worth drawing up close
+	if (!HealthBars)
+	{
+		return;
+	}
+
+	if (effective <= ESignificance::MID)
+	{
+		FVector offset(0.0f, 0.0f, GetCapsuleComponent()->GetScaledCapsuleHalfHeight() + HealthBarHeight);
+		HealthBars->ShowBar(this, offset, GetHealthFraction());
+	}
+	else
+	{
+		HealthBars->HideBar(this);
+	}
+}
@@ -8,9 +8,11 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "CG_GlobalDefines.h"
+#include "CG_SignificanceSubsystem.h"
+#include "CG_CombatStateSubsystem.h"
 #include "CG_EnemyCharacter.generated.h"
 
-class UWidgetComponent;
+class UCG_HealthBarSubsystem;
 
 UCLASS(Blueprintable)
 class CELESTIALGROVE_API ACG_EnemyCharacter : public ACharacter
@@ -22,7 +24,7 @@ public:
 	ACG_EnemyCharacter();
 
 	virtual void BeginPlay() override;
-	virtual void Tick(float deltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
 
 	UFUNCTION(BlueprintCallable)
 	void ApplyDamage(int32 damage);
@@ -33,7 +35,19 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void ApplyForce(FVector direction, float strength);
 
+	// Only the significance subsystem should call this
+	void SetSignificance(ESignificance significance);
+	FORCEINLINE ESignificance GetSignificance() const;
+
+	// Only the ragdoll subsystem should call these
+	void EnterRagdoll();
+	void ExitRagdoll();
+	void FollowRagdoll();
+	FORCEINLINE FName GetRagdollBone() const;
+	FORCEINLINE float GetRagdollSettleSpeed() const;
+
 // ============================================================
+	// Starting values, the live ones are in the combat state subsystem and mirrored back here
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Gameplay)
 	FCG_Stats Stats;
 
@@ -60,20 +74,62 @@ protected:
 	void OnFinishedStandingUp();
 
 // ============================================================
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-	TObjectPtr<UWidgetComponent> Health;
+	// How far above the top of the capsule the health bar sits, the bar itself is drawn by the HUD
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Gameplay)
+	float HealthBarHeight;
 
 	// If the force being applied is greater than this value then the enemy will ragdoll.
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Gameplay)
 	float PushByForceResistance;
 
+	// Speed the followed body has to stay under for the ragdoll to count as settled
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Gameplay)
-	float RagdollSettleTolerance;
+	float RagdollSettleSpeed;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Gameplay)
 	FName RagdollSocketToFollow;
 
 	FVector CapsuleToMeshOffset;
-	FVector PreviousMeshPosition;
 	uint32 IsInRagdoll:1;
+
+private:
+// ============================================================
+	void ApplySignificance();
+	void OnCombatEvent(ECombatEvent event, int32 health, uint8 status);
+	FORCEINLINE float GetHealthFraction() const;
+
+// ============================================================
+	UCG_SignificanceSubsystem * SignificanceSubsystem;
+	UCG_HealthBarSubsystem * HealthBars;
+	UCG_CombatStateSubsystem * CombatState;
+	FCG_TargetHandle TargetHandle;
+	int32 CombatId;
+	ESignificance Significance;
+
+	// Body on the followed socket, what settling is measured on
+	FName RagdollBone;
 };
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE ESignificance ACG_EnemyCharacter::GetSignificance() const
+{
+	return Significance;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float ACG_EnemyCharacter::GetHealthFraction() const
+{
+	return CombatState->GetHealthFraction(CombatId);
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE FName ACG_EnemyCharacter::GetRagdollBone() const
+{
+	return RagdollBone;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float ACG_EnemyCharacter::GetRagdollSettleSpeed() const
+{
+	return RagdollSettleSpeed;
+}
+// ============================================================
@@ -9,6 +9,11 @@
 #include "GameFramework/PlayerController.h"
 #include "CG_PlayerCharacter.h"
 #include "CG_SpellBase.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_PhysicsSleepSubsystem.h"
+#include "CG_StatusSubsystem.h"
+#include "CG_CombatStateSubsystem.h"
+#include "CG_Profiling.h"
 
 // -----------------------------------------------------------------------------------------
 ACG_InteractableBase::ACG_InteractableBase()
@@ -16,12 +21,18 @@ ACG_InteractableBase::ACG_InteractableBase()
 	PrimaryActorTick.bCanEverTick = false;
 	PrimaryActorTick.bStartWithTickEnabled = false;
 
+	// NOTE(RyanC): Props don't simulate until something moves them, the physics sleep subsystem
+	// turns it back off once they've settled. Hit events are how a resting prop notices it was bumped.
 	StaticMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Static Mesh"));
-	StaticMesh->SetSimulatePhysics(true);
+	StaticMesh->SetMobility(EComponentMobility::Movable);
+	StaticMesh->SetSimulatePhysics(false);
+	StaticMesh->SetNotifyRigidBodyCollision(true);
 	RootComponent = StaticMesh;
 
 	InspectionCenter = CreateDefaultSubobject<USceneComponent>(TEXT("Inspection Center"));
 	InspectionCenter->SetupAttachment(StaticMesh);
+
+	CombatId = INDEX_NONE;
 }
 
 // -----------------------------------------------------------------------------------------
@@ -31,8 +42,39 @@ void ACG_InteractableBase::BeginPlay()
 
 	Target.OwningActor = this;
 	Target.ApplyDamageDelegate.AddUObject(this, &ACG_InteractableBase::ApplyDamage);
-	Target.ApplyStatusDelegate.AddUObject(this, &ACG_InteractableBase::ApplyStatus);
+	Target.ApplyStatusDelegate.AddUObject(this, &ACG_InteractableBase::OnStatusApplied);
 	Target.ApplyForceDelegate.AddUObject(this, &ACG_InteractableBase::ApplyForce);
+
+	TargetHandle = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>()->RegisterTarget(this, &Target, ESpellTargetKind::INANIMATE, StaticMesh);
+	CombatId = GetWorld()->GetSubsystem<UCG_CombatStateSubsystem>()->RegisterCombatant(TargetHandle, Stats,
+		FCG_CombatEventDelegate::CreateUObject(this, &ACG_InteractableBase::OnCombatEvent));
+
+	StaticMesh->OnComponentHit.AddUniqueDynamic(this, &ACG_InteractableBase::OnMeshHit);
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_InteractableBase::EndPlay(const EEndPlayReason::Type endPlayReason)
+{
+	UCG_CombatStateSubsystem * combatState = GetWorld()->GetSubsystem<UCG_CombatStateSubsystem>();
+	if (combatState && CombatId != INDEX_NONE)
+	{
+		combatState->UnregisterCombatant(CombatId);
+		CombatId = INDEX_NONE;
+	}
+
+	UCG_TargetRegistrySubsystem * registry = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	if (registry)
+	{
+		registry->UnregisterTarget(this);
+	}
+
+	UCG_PhysicsSleepSubsystem * sleep = GetWorld()->GetSubsystem<UCG_PhysicsSleepSubsystem>();
+	if (sleep)
+	{
+		sleep->ForgetBody(StaticMesh);
+	}
+
+	Super::EndPlay(endPlayReason);
 }
 
 // -----------------------------------------------------------------------------------------
@@ -48,18 +90,24 @@ void ACG_InteractableBase::OnInteracted(ACG_PlayerCharacter * player)
 	if (COMPARE_FLAG(Interactions, (uint8)EInteractableFlags::INTERACTABLE))
 	{
 		UE_LOG(LogCelestialGrove, Log, TEXT("Interactable %s began interaction"), *GetFName().ToString());
+
+		CG_SCOPE_BLUEPRINT_EVENT(Interactable, Interact);
 		Interact(player);
 	}
 	// If no interactions are left then we check if the object can be inspected
 	else if (COMPARE_FLAG(Interactions, (uint8)EInteractableFlags::INSPECTABLE))
 	{
 		UE_LOG(LogCelestialGrove, Log, TEXT("Interactable %s began inspection"), *GetFName().ToString());
+
+		CG_SCOPE_BLUEPRINT_EVENT(Interactable, OnBeginInspection);
 		OnBeginInspection(player);
 	}
 	// Lastly we loot the object
 	else if (COMPARE_FLAG(Interactions, (uint8)EInteractableFlags::LOOTABLE))
 	{
 		UE_LOG(LogCelestialGrove, Log, TEXT("Interactable %s began looting"), *GetFName().ToString());
+
+		CG_SCOPE_BLUEPRINT_EVENT(Interactable, Loot);
 		Loot(player);
 	}
 }
@@ -80,6 +128,8 @@ FVector ACG_InteractableBase::GetCenterOfMass() const
 void ACG_InteractableBase::OnBeginInspection_Implementation(ACG_PlayerCharacter * player)
 {
 	player->BeginInspection(this);
+	GetWorld()->GetSubsystem<UCG_PhysicsSleepSubsystem>()->ForgetBody(StaticMesh);
+
 	StaticMesh->SetEnableGravity(false);
 	StaticMesh->SetSimulatePhysics(false);
 	StaticMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -89,8 +139,10 @@ void ACG_InteractableBase::OnBeginInspection_Implementation(ACG_PlayerCharacter
 void ACG_InteractableBase::OnEndInspection_Implementation(FVector throwVector, float throwStrength, bool shouldThrow)
 {
 	StaticMesh->SetEnableGravity(true);
-	StaticMesh->SetSimulatePhysics(true);
 	StaticMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	// Even when it isn't thrown it has to fall back down from wherever it was being held
+	WakePhysics();
 	
 	if (shouldThrow)
 	{
@@ -101,22 +153,71 @@ void ACG_InteractableBase::OnEndInspection_Implementation(FVector throwVector, f
 // -----------------------------------------------------------------------------------------
 void ACG_InteractableBase::ApplyDamage(int32 damage)
 {
-	Stats.Health = FMath::Clamp(Stats.Health - damage, 0, Stats.Health);
+	GetWorld()->GetSubsystem<UCG_CombatStateSubsystem>()->ApplyDamage(CombatId, damage);
+}
 
-	if (Stats.Health == 0)
-	{
-		OnDestroyed();
-	}
-	else
+// -----------------------------------------------------------------------------------------
+void ACG_InteractableBase::ApplyForce(FVector direction, float strength)
+{
+	WakePhysics();
+	StaticMesh->AddForce(direction * strength * StaticMesh->GetMass());
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_InteractableBase::OnStatusApplied(uint8 status)
+{
+	GetWorld()->GetSubsystem<UCG_StatusSubsystem>()->ApplyStatus(TargetHandle, status);
+
+	CG_SCOPE_BLUEPRINT_EVENT(Interactable, ApplyStatus);
+	ApplyStatus(status);
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_InteractableBase::OnCombatEvent(ECombatEvent event, int32 health, uint8 status)
+{
+	Stats.Health = health;
+	Stats.Status = status;
+
+	switch (event)
 	{
-		OnDamaged();
+		case ECombatEvent::DAMAGED:
+		{
+			CG_SCOPE_BLUEPRINT_EVENT(Interactable, OnDamaged);
+			OnDamaged();
+		}
+		break;
+
+		case ECombatEvent::DIED:
+		{
+			CG_SCOPE_BLUEPRINT_EVENT(Interactable, OnDestroyed);
+			OnDestroyed();
+		}
+		break;
+
+		default:
+			break;
 	}
 }
 
 // -----------------------------------------------------------------------------------------
-void ACG_InteractableBase::ApplyForce(FVector direction, float strength)
+void ACG_InteractableBase::WakePhysics()
 {
-	// NOTE(RyanC): Probably will end up only turning on physics when a force happens and then disable when settled.
-	// for now its just on by default.
-	StaticMesh->AddForce(direction * strength * StaticMesh->GetMass());
+	GetWorld()->GetSubsystem<UCG_PhysicsSleepSubsystem>()->WakeBody(StaticMesh);
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_InteractableBase::OnMeshHit(UPrimitiveComponent * hitComponent, AActor * otherActor, UPrimitiveComponent * otherComponent, FVector normalImpulse, const FHitResult & hit)
+{
+	// Awake props already react to contacts on their own
+	if (StaticMesh->IsSimulatingPhysics() || !otherComponent)
+	{
+		return;
+	}
+
+	// NOTE(RyanC): Standing on a prop or leaning on it keeps generating hits, only something
+	// actually moving into it should wake it up.
+	if (otherComponent->IsSimulatingPhysics() || !otherComponent->GetComponentVelocity().IsNearlyZero(1.0f))
+	{
+		WakePhysics();
+	}
 }
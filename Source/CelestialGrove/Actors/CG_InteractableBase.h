@@ -8,11 +8,13 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "CG_GlobalDefines.h"
+#include "CG_CombatStateSubsystem.h"
 #include "CG_InteractableBase.generated.h"
 
 class UStaticMeshComponent;
 class ACG_PlayerCharacter;
 class APlayerController;
+class UPrimitiveComponent;
 
 // ============================================================
 UENUM(BlueprintType, Meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
@@ -38,6 +40,7 @@ public:
 	ACG_InteractableBase();
 	
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
 
 	UFUNCTION(BlueprintCallable)
 	void OnInteracted(ACG_PlayerCharacter * player);
@@ -50,6 +53,7 @@ public:
 	void OnEndInspection_Implementation(FVector throwVector, float throwStrength, bool shouldThrow = true);
 
 // ===========================================================
+	// Starting values, the live ones are in the combat state subsystem and mirrored back here
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Gameplay)
 	FCG_Stats Stats;
 
@@ -70,8 +74,9 @@ protected:
 	UFUNCTION(BlueprintImplementableEvent)
 	void OnDestroyed();
 
+	// Called after the status engine has taken the status, Stats.Status is already up to date
 	UFUNCTION(BlueprintImplementableEvent)
-	void ApplyStatus(uint8 status); // NOTE(RyanC): not sure of the use of this yet but implementing it just in case
+	void ApplyStatus(uint8 status);
 
 	UFUNCTION(BlueprintNativeEvent)
 	void OnBeginInspection(ACG_PlayerCharacter * player);
@@ -91,4 +96,14 @@ private:
 // ============================================================
 	void ApplyDamage(int32 damage);
 	void ApplyForce(FVector direction, float strength);
+	void OnStatusApplied(uint8 status);
+	void OnCombatEvent(ECombatEvent event, int32 health, uint8 status);
+	void WakePhysics();
+
+	UFUNCTION()
+	void OnMeshHit(UPrimitiveComponent * hitComponent, AActor * otherActor, UPrimitiveComponent * otherComponent, FVector normalImpulse, const FHitResult & hit);
+
+// ============================================================
+	FCG_TargetHandle TargetHandle;
+	int32 CombatId;
 };
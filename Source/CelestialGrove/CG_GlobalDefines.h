@@ -1,16 +1,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "CG_CoreFlags.h"
 #include "CG_GlobalDefines.generated.h"
 
 // ============================================================
 // Global defines for Celestial Grove
 // ============================================================
-#define COMPARE_FLAG(field, flag) ((field & flag) == flag)
-#define TOGGLE_FLAG(field, flag) (field = field ^ flag)
-#define SET_FLAG(field, flag) (field = field | flag)
-#define CLEAR_FLAG(field, flag) (field = field & ~flag)
-
+// The flag helpers (COMPARE_FLAG and friends) are in CG_CoreFlags.h, shared with the core build.
 #define INTERACTABLE_COLLISION_CHANNEL ECollisionChannel::ECC_GameTraceChannel1
 #define SPELL_TRACE_CHANNEL ECollisionChannel::ECC_GameTraceChannel2
 #define INANIMATE_COLLISION_CHANNEL ECollisionChannel::ECC_GameTraceChannel3
@@ -20,6 +18,7 @@
 #define global static
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCelestialGrove, Log, All);
+DECLARE_STATS_GROUP(TEXT("CelestialGrove"), STATGROUP_CelestialGrove, STATCAT_Advanced);
 
 // ============================================================
 UENUM(BlueprintType, Meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
@@ -51,6 +50,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
 	FVector ImpactDirection;
 
+	// 1 at the center of an area query down to 0 at its edge, always 1 for anything else
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	float DistanceFalloff = 1.0f;
+
 	FApplyDamageSignature ApplyDamageDelegate;
 	FApplyStatusSignature ApplyStatusDelegate;
 	FApplyForceSignature ApplyForceDelegate;
@@ -0,0 +1,42 @@
+// ============================================================
+// FILE: CG_Profiling.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "CG_GlobalDefines.h"
+
+// ============================================================
+// Profiling for Celestial Grove
+// ============================================================
+// Every scope goes to three places: the CelestialGrove stat group for in editor, the CelestialGrove
+// Insights channel (-trace=cpu,CelestialGrove) and the CelestialGrove CSV category. Stats are
+// compiled out of Test and Shipping, the trace channel and CSV category are what to compare
+// captures from those builds with.
+UE_TRACE_CHANNEL_EXTERN(CelestialGroveChannel, CELESTIALGROVE_API);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(CELESTIALGROVE_API, CelestialGrove);
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(CELESTIALGROVE_API, CelestialGroveBlueprint);
+
+// Times the rest of the scope, stat has to be declared with DECLARE_CYCLE_STAT in STATGROUP_CelestialGrove
+#define CG_SCOPE_CYCLE_COUNTER(stat) \
+	SCOPE_CYCLE_COUNTER(stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#stat, CelestialGroveChannel); \
+	CSV_SCOPED_TIMING_STAT(CelestialGrove, stat)
+
+// Wraps native code calling out to a BlueprintImplementableEvent (or a BlueprintNativeEvent that
+// can be overridden), declares its own stat so only use it once per scope.
+#define CG_SCOPE_BLUEPRINT_EVENT(owner, event) \
+	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("BP " #owner " " #event), STAT_BlueprintEvent_##owner##_##event, STATGROUP_CelestialGrove); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("BP " #owner " " #event, CelestialGroveChannel); \
+	CSV_SCOPED_TIMING_STAT(CelestialGroveBlueprint, owner##_##event)
+
+// Counter in the stat group that's also written out to CSV captures every time it's set
+#define CG_SET_DWORD_STAT(stat, value) \
+	SET_DWORD_STAT(stat, value); \
+	CSV_CUSTOM_STAT(CelestialGrove, stat, (int32)(value), ECsvCustomStatOp::Set)
@@ -1,5 +1,6 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class CelestialGrove : ModuleRules
@@ -23,11 +24,19 @@ public class CelestialGrove : ModuleRules
 													"./CelestialGrove",
 													"./CelestialGrove/Actors/",
 													"./CelestialGrove/Player",
-													"./CelestialGrove/Objects"
+													"./CelestialGrove/Objects",
+													"./CelestialGrove/Systems"
 												 });
 
-		// Uncomment if you are using Slate UI
-		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
+		// Engine independent core (spell algebra, flags, cooldowns), header only. It has its own
+		// CMake build for tests and benchmarks, see Source/CelestialGroveCore/CMakeLists.txt
+		PublicIncludePaths.Add(Path.Combine(ModuleDirectory, "..", "CelestialGroveCore", "Include"));
+
+		// Health bars are drawn straight from slate
+		PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
+
+		// Benchmark mode writes its results as JSON and reads the game thread time from RenderCore
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json", "RenderCore" });
 		
 		// Uncomment if you are using online features
 		// PrivateDependencyModuleNames.Add("OnlineSubsystem");
@@ -3,7 +3,12 @@
 #include "CelestialGrove.h"
 #include "Modules/ModuleManager.h"
 #include "CG_GlobalDefines.h"
+#include "CG_Profiling.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CelestialGrove, "CelestialGrove" );
 
 DEFINE_LOG_CATEGORY(LogCelestialGrove);
+
+UE_TRACE_CHANNEL_DEFINE(CelestialGroveChannel);
+CSV_DEFINE_CATEGORY_MODULE(CELESTIALGROVE_API, CelestialGrove, true);
+CSV_DEFINE_CATEGORY_MODULE(CELESTIALGROVE_API, CelestialGroveBlueprint, true);
@@ -0,0 +1,189 @@
+// ============================================================
+// FILE: CG_CompiledSpell.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_CompiledSpell.h"
+#include "CG_SpellComponentRegistry.h"
+
+// NOTE(RyanC): Spells are only ever built on the game thread so the cache doesn't need a lock.
+// Entries are weak so a loadout nobody is using anymore gets freed with its last spell.
+global TMap<uint64, TWeakPtr<const FCG_CompiledSpell, ESPMode::ThreadSafe>> GCompiledSpellCache;
+
+// -----------------------------------------------------------------------------------------
+FCG_CompiledSpell::FCG_CompiledSpell(TArrayView<const ESpellComponentType> components, const UCG_SpellComponentRegistry & registry)
+{
+	check(components.Num() > 0);
+	// NOTE(RyanC): Not sure if i want to inforce effects being the base or not yet
+	// check(registry.GetStats(components[0]).Category == ESpellComponentCategory::EFFECT);
+
+	for (ESpellComponentType type : components)
+	{
+		checkf(registry.IsRegistered(type), TEXT("Spell component %s is missing from the component table!"), *UEnum::GetValueAsString(type));
+	}
+
+	Key = MakeKey(components, registry);
+
+	// NOTE(RyanC): The values and masks come out of the core, this only sorts the components into
+	// their categories.
+	const CGCore::FSpellFold fold = CGCore::FoldComponents((const uint8 *)components.GetData(), components.Num(), [&registry](uint8 type) -> const FCG_SpellComponentStats &
+	{
+		return registry.GetStats((ESpellComponentType)type);
+	});
+
+	BaseComponent = components[0];
+	BaseCategory = registry.GetStats(components[0]).Category;
+
+	for (int32 i = 0; i < components.Num(); ++i)
+	{
+		const FCG_SpellComponentStats & stats = registry.GetStats(components[i]);
+
+		switch(stats.Category)
+		{
+			case ESpellComponentCategory::TARGETING:
+			{
+				TargetingComponents.Emplace(stats.Type);
+			}
+			break;
+
+			case ESpellComponentCategory::EFFECT:
+			{
+				EffectComponents.Emplace(stats.Type);
+			}
+			break;
+
+			case ESpellComponentCategory::MODIFIERS:
+			{
+				ModifierComponents.Emplace(stats.Type);
+			}
+			break;
+
+			default:
+				checkNoEntry();
+		}
+	}
+
+	static_assert(sizeof(CategoryMasks) == sizeof(fold.CategoryMasks), "Category masks don't match the core");
+	FMemory::Memcpy(CategoryMasks, fold.CategoryMasks, sizeof(CategoryMasks));
+
+	SpellEffectStrength = (uint8)fold.EffectStrength;
+	SpellTargetStrength = fold.TargetStrength;
+	SpellCooldown = fold.Cooldown;
+
+	checkf(CGCore::IsValidSpell(fold), TEXT("Invalid spell! Needs 1 targeting component and 1 effect component"));
+
+	// NOTE(RyanC): The key only keeps the base, the effect base and how many of each type there
+	// are, so every loadout sharing this instance has to see the categories in the same order.
+	const ESpellComponentType effectBase = EffectComponents[0];
+	TargetingComponents.Sort();
+	ModifierComponents.Sort();
+	EffectComponents.Sort();
+	EffectComponents.RemoveSingle(effectBase);
+	EffectComponents.Insert(effectBase, 0);
+
+	BuildTargetingStyle();
+	NativeTargeting = GetNativeTargetingFunction(TargetingStyle);
+	EffectProgram.Compile(EffectComponents, ModifierComponents, SpellEffectStrength);
+
+	CollisionType = COMPARE_FLAG(CategoryMasks[(int32)ESpellComponentCategory::MODIFIERS], (uint16)(1 << (int32)ESpellComponentType::INANIMATE_MODIFIER))
+		? ESpellCollisionType::INANIMATE_ONLY
+		: ESpellCollisionType::ALL;
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_CompiledSpellRef FCG_CompiledSpell::FindOrCompile(TArrayView<const ESpellComponentType> components)
+{
+	check(IsInGameThread());
+
+	UCG_SpellComponentRegistry * registry = UCG_SpellComponentRegistry::Get();
+	check(registry);
+
+	uint64 key = MakeKey(components, *registry);
+	TWeakPtr<const FCG_CompiledSpell, ESPMode::ThreadSafe> & entry = GCompiledSpellCache.FindOrAdd(key);
+
+	FCG_CompiledSpellPtr compiled = entry.Pin();
+	if (!compiled.IsValid())
+	{
+		TSharedRef<FCG_CompiledSpell, ESPMode::ThreadSafe> newSpell = MakeShared<FCG_CompiledSpell, ESPMode::ThreadSafe>(components, *registry);
+		newSpell->RequestAssets(*registry);
+
+		compiled = newSpell;
+		entry = compiled;
+	}
+
+	return compiled.ToSharedRef();
+}
+
+// -----------------------------------------------------------------------------------------
+uint64 FCG_CompiledSpell::MakeKey(TArrayView<const ESpellComponentType> components, const UCG_SpellComponentRegistry & registry)
+{
+	check(components.Num() > 0);
+
+	uint64 key = 0;
+	verifyf(CGCore::MakeSpellKey((const uint8 *)components.GetData(), components.Num(), key), TEXT("Too many copies of one component in a spell!"));
+
+	// The first effect is what GetEffectBase hands out, loadouts that only differ in it can't share
+	for (ESpellComponentType type : components)
+	{
+		if (registry.GetStats(type).Category == ESpellComponentCategory::EFFECT)
+		{
+			CGCore::SetKeyEffectBase(key, (CGCore::EComponentType)type);
+			break;
+		}
+	}
+
+	return key;
+}
+
+// -----------------------------------------------------------------------------------------
+bool FCG_CompiledSpell::AreAssetsLoaded() const
+{
+	for (const TSharedPtr<FStreamableHandle> & handle : AssetHandles)
+	{
+		if (!handle->HasLoadCompleted())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_CompiledSpell::RequestAssets(UCG_SpellComponentRegistry & registry)
+{
+	uint16 componentMask = 0;
+	for (uint16 categoryMask : CategoryMasks)
+	{
+		componentMask |= categoryMask;
+	}
+
+	// Once per component type, duplicates would just hold the same handle twice
+	for (int32 i = 0; i < SPELL_COMPONENT_TYPE_COUNT; ++i)
+	{
+		if (COMPARE_FLAG(componentMask, (uint16)(1 << i)))
+		{
+			TSharedPtr<FStreamableHandle> handle = registry.RequestComponentAssets((ESpellComponentType)i);
+			if (handle.IsValid())
+			{
+				AssetHandles.Emplace(MoveTemp(handle));
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_CompiledSpell::ResetCache()
+{
+	check(IsInGameThread());
+	GCompiledSpellCache.Reset();
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_CompiledSpell::BuildTargetingStyle()
+{
+	const CGCore::ETargetingStyle style = CGCore::GetTargetingStyle(CategoryMasks[(int32)ESpellComponentCategory::TARGETING], TargetingComponents.Num());
+	check(style != CGCore::ETargetingStyle::INVALID);
+
+	TargetingStyle = (ETargetingStyles)style;
+}
@@ -0,0 +1,94 @@
+// ============================================================
+// FILE: CG_CompiledSpell.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SharedPointer.h"
+#include "Engine/StreamableManager.h"
+#include "CG_SpellTypes.h"
+#include "CG_SpellTargeting.h"
+#include "CG_SpellEffectProgram.h"
+
+class UCG_SpellComponentRegistry;
+struct FCG_CompiledSpell;
+
+typedef TSharedRef<const FCG_CompiledSpell, ESPMode::ThreadSafe> FCG_CompiledSpellRef;
+typedef TSharedPtr<const FCG_CompiledSpell, ESPMode::ThreadSafe> FCG_CompiledSpellPtr;
+
+// ============================================================
+// Everything about a spell that only depends on the components it was built from.
+// These are interned by component multiset, base and effect base so every caster with the same
+// loadout shares one instance, spells only hold on to their own mutable state. Components are
+// kept per category in type order, the effect base always first.
+struct CELESTIALGROVE_API FCG_CompiledSpell
+{
+public:
+// ============================================================
+	FCG_CompiledSpell(TArrayView<const ESpellComponentType> components, const UCG_SpellComponentRegistry & registry);
+
+	static FCG_CompiledSpellRef FindOrCompile(TArrayView<const ESpellComponentType> components);
+	static uint64 MakeKey(TArrayView<const ESpellComponentType> components, const UCG_SpellComponentRegistry & registry);
+	static void ResetCache();
+
+	FORCEINLINE bool HasComponentsInCategory(ESpellComponentCategory category, uint16 typeMask) const;
+	FORCEINLINE const TArray<ESpellComponentType> & GetComponentsInCategory(ESpellComponentCategory category) const;
+	bool AreAssetsLoaded() const;
+
+// ============================================================
+	TArray<ESpellComponentType> TargetingComponents;
+	TArray<ESpellComponentType> EffectComponents;
+	TArray<ESpellComponentType> ModifierComponents;
+
+	// Bit (1 << ESpellComponentType) is set for every component type in the category
+	uint16 CategoryMasks[SPELL_COMPONENT_CATEGORY_COUNT];
+
+	uint64 Key;
+	ESpellComponentType BaseComponent;
+	ESpellComponentCategory BaseCategory;
+	ETargetingStyles TargetingStyle;
+	ESpellCollisionType CollisionType;
+	FCG_NativeTargetingFn NativeTargeting;
+	FCG_SpellEffectProgram EffectProgram;
+
+	int32 SpellEffectStrength;
+	float SpellTargetStrength;
+	float SpellCooldown;
+
+	// One per component that has assets, shared with every other spell using that component.
+	TArray<TSharedPtr<FStreamableHandle>, TInlineAllocator<4>> AssetHandles;
+
+private:
+// ============================================================
+	void BuildTargetingStyle();
+	void RequestAssets(UCG_SpellComponentRegistry & registry);
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool FCG_CompiledSpell::HasComponentsInCategory(ESpellComponentCategory category, uint16 typeMask) const
+{
+	return COMPARE_FLAG(CategoryMasks[(int32)category], typeMask);
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE const TArray<ESpellComponentType> & FCG_CompiledSpell::GetComponentsInCategory(ESpellComponentCategory category) const
+{
+	switch (category)
+	{
+		case ESpellComponentCategory::TARGETING:
+			return TargetingComponents;
+
+		case ESpellComponentCategory::MODIFIERS:
+			return ModifierComponents;
+
+		default:
+			checkNoEntry();
+
+		case ESpellComponentCategory::EFFECT:
+			return EffectComponents;
+	}
+}
+// ============================================================
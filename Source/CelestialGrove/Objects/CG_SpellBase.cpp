@@ -8,147 +8,202 @@
 #include "NiagaraFunctionLibrary.h"
 #include "NiagaraComponent.h"
 #include "CG_PlayerCharacter.h"
+#include "CG_SpellComponentRegistry.h"
+#include "CG_EffectPoolSubsystem.h"
 #include "Sound/SoundCue.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Build Spell"), STAT_BuildSpell, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Spell Targeting"), STAT_SpellTargeting, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Update Spell (Effect)"), STAT_UpdateSpellEffect, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Apply Damage To Targets"), STAT_ApplyDamageToTargets, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Apply Status To Targets"), STAT_ApplyStatusToTargets, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Apply Force To Targets"), STAT_ApplyForceToTargets, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targets Per Cast"), STAT_TargetsPerCast, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Casts Before Assets Loaded"), STAT_CastsBeforeAssetsLoaded, STATGROUP_CelestialGrove);
 
 // -----------------------------------------------------------------------------------------
 UCG_SpellBase::UCG_SpellBase()
 {
-	CurrentSpellStep = ESpellComponentCategory::NONE;
-
-	CurrentCooldown = 0.0f;
+	Runtime = nullptr;
+	RuntimeId = INDEX_NONE;
+	TargetRegistry = nullptr;
+	CombatCommands = nullptr;
+
+	TargetingDistance = 2000.0f;
+	ConeAngle = 30.0f;
+	BeamRadius = 50.0f;
+	ProjectileSpeed = 1500.0f;
+	ForceScale = 20.0f;
+
+	RemainingPulses = 0;
+	PulseTimer = 0.0f;
 }
 
 // -----------------------------------------------------------------------------------------
-void UCG_SpellBase::BuildSpell(TArray<FCG_SpellComponent> & components)
+void UCG_SpellBase::BeginDestroy()
 {
-	check(components.Num() > 0);
-	// NOTE(RyanC): Not sure if i want to inforce effects being the base or not yet
-	// check(components[0].Category == ESpellComponentCategory::EFFECT);
+	if (Runtime)
+	{
+		Runtime->UnregisterSpell(RuntimeId);
+		Runtime = nullptr;
+		RuntimeId = INDEX_NONE;
+	}
 
-	BaseCategory = components[0].Category;
-	float cooldown = components[0].BaseCooldown;
-	float effectStrength = components[0].BaseEffectStrength;
-	float targetStrength = components[0].BaseTargetStrenth;
+	Super::BeginDestroy();
+}
 
-	for (int32 i = 0; i < components.Num(); ++i)
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::RegisterWithRuntime()
+{
+	if (Runtime)
 	{
-		switch(components[i].Category)
-		{
-			case ESpellComponentCategory::TARGETING:
-			{
-				TargetingComponents.Emplace(components[i]);
-			}
-			break;
+		return;
+	}
 
-			case ESpellComponentCategory::EFFECT:
-			{
-				EffectComponents.Emplace(components[i]);
-			}
-			break;
+	UWorld * world = GetWorld();
+	checkf(world, TEXT("Spell %s needs to be outered to something in a world before it can be built."), *GetName());
 
-			case ESpellComponentCategory::MODIFIERS:
-			{
-				ModifierComponents.Emplace(components[i]);
-			}
-			break;
+	Runtime = world->GetSubsystem<UCG_SpellRuntimeSubsystem>();
+	check(Runtime);
+	RuntimeId = Runtime->RegisterSpell(this);
 
-			default:
-				checkNoEntry();
-		}
-		
-		// NOTE(RyanC): Base should not modify itself
-		if (i != 0)
-		{
-			cooldown *= components[i].CooldownModifier;
-			effectStrength *= components[i].EffectModifier;
-			targetStrength += components[i].TargetModifier;
-		}
-	}
-
-	SpellEffectStrength = (uint8)effectStrength;
-	SpellTargetStrength = targetStrength;
-	SpellCooldown = cooldown;
+	TargetRegistry = world->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	check(TargetRegistry);
 
-	checkf(TargetingComponents.Num() > 0 && EffectComponents.Num() > 0, TEXT("Invalid spell! Needs 1 targeting component and 1 effect component"));
+	CombatCommands = world->GetSubsystem<UCG_CombatCommandSubsystem>();
+	check(CombatCommands);
+}
 
-	BuildTargetingStyle();
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::SetSpellStep(ESpellComponentCategory step)
+{
+	check(Runtime);
+	Runtime->SetStep(RuntimeId, step);
 }
 
 // -----------------------------------------------------------------------------------------
-void UCG_SpellBase::BuildTargetingStyle()
+void UCG_SpellBase::BuildSpell(TArray<FCG_SpellComponent> & components)
 {
-	if (TargetingComponents.Num() >= 3)
-	{
-		TargetingStyle = ETargetingStyles::CONE;
-		return;
-	}
+	CG_SCOPE_CYCLE_COUNTER(STAT_BuildSpell);
 
-	int32 targetField = 0;
-	for (const FCG_SpellComponent & component : TargetingComponents)
+	// NOTE(RyanC): Only the type is read from these rows, the values all come from the component registry.
+	TArray<ESpellComponentType, TInlineAllocator<8>> types;
+	for (const FCG_SpellComponent & component : components)
 	{
-		SET_FLAG(targetField, 1 << (int32)component.Type);
+		types.Emplace(component.Type);
 	}
 
-	if (COMPARE_FLAG(targetField, RADIUS_AT_POINT_FLAG))
-	{
-		TargetingStyle = ETargetingStyles::RADIUS_AT_POINT;
-	}
-	else if (COMPARE_FLAG(targetField, TARGET_SELF_FLAG))
+	CompiledSpell = FCG_CompiledSpell::FindOrCompile(types);
+	RegisterWithRuntime();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::BuildSpellFromTypes(TArray<ESpellComponentType> & components)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_BuildSpell);
+
+	CompiledSpell = FCG_CompiledSpell::FindOrCompile(components);
+	RegisterWithRuntime();
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_SpellBase::OnBeginCast(const AActor * caster)
+{
+	check(CompiledSpell.IsValid());
+	check(Runtime);
+	check(!IsSpellOnCooldown());
+
+	const bool assetsLoaded = CompiledSpell->AreAssetsLoaded();
+	if (!assetsLoaded)
 	{
-		TargetingStyle = ETargetingStyles::TARGET_SELF;
+		INC_DWORD_STAT(STAT_CastsBeforeAssetsLoaded);
+		UE_LOG(LogCelestialGrove, Verbose, TEXT("Spell %s cast before its assets finished loading."), *GetName());
 	}
-	else if (COMPARE_FLAG(targetField, PROJECTILE_FLAG))
+
+	Targets.Reset();
+	Runtime->StartCasting(RuntimeId, caster, CompiledSpell->SpellCooldown);
+
 	{
-		TargetingStyle = ETargetingStyles::PROJECTILE;
+		CG_SCOPE_BLUEPRINT_EVENT(Spell, StartTargeting);
+		StartTargeting(caster);
 	}
-	else if (COMPARE_FLAG(targetField, RADIUS_AT_ORIGIN_FLAG))
+
 	{
-		TargetingStyle = ETargetingStyles::RADIUS_AT_ORIGIN;
+		CG_SCOPE_CYCLE_COUNTER(STAT_SpellTargeting);
+		CompiledSpell->NativeTargeting(*this, caster);
 	}
-	else if (COMPARE_FLAG(targetField, BEAM_FLAG))
+
+	return assetsLoaded;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_SpellBase::AreSpellAssetsLoaded() const
+{
+	return CompiledSpell.IsValid() && CompiledSpell->AreAssetsLoaded();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::OnFinishTargeting(const AActor * caster)
+{
+	if (GetSpellStep() != ESpellComponentCategory::TARGETING)
 	{
-		TargetingStyle = ETargetingStyles::BEAM;
+		return;
 	}
-	else if (COMPARE_FLAG(targetField, SELF_FORWARD_FLAG))
+
+	CG_SET_DWORD_STAT(STAT_TargetsPerCast, Targets.Num());
+
+	// Early exit, all spell should have some target
+	if (Targets.Num() == 0)
 	{
-		TargetingStyle = ETargetingStyles::SELF_FORWARD;
+		OnFinishEffect(caster);
+		return;
 	}
-	else
+
+	SetSpellStep(ESpellComponentCategory::EFFECT);
+
 	{
-		checkNoEntry();
+		CG_SCOPE_BLUEPRINT_EVENT(Spell, StartEffect);
+		StartEffect(caster);
 	}
+
+	RemainingPulses = CompiledSpell->EffectProgram.PulseCount;
+	RunEffectPulse(caster);
 }
 
 // -----------------------------------------------------------------------------------------
-void UCG_SpellBase::OnBeginCast(const ACG_PlayerCharacter * player)
+void UCG_SpellBase::RunEffectPulse(const AActor * caster)
 {
-	check(TargetingComponents.Num() > 0);
-	check(EffectComponents.Num() > 0);
-	check(!IsSpellOnCooldown());
+	check(RemainingPulses > 0);
 
-	CurrentSpellStep = ESpellComponentCategory::TARGETING;
-	CurrentCooldown = SpellCooldown;
-	StartTargeting(player);
+	CompiledSpell->EffectProgram.Execute(Targets, *CombatCommands, ForceScale);
+	--RemainingPulses;
+	PulseTimer = CompiledSpell->EffectProgram.PulseInterval;
+
+	if (RemainingPulses == 0)
+	{
+		OnFinishEffect(caster);
+	}
 }
 
 // -----------------------------------------------------------------------------------------
-void UCG_SpellBase::OnFinishTargeting(const ACG_PlayerCharacter * player)
+void UCG_SpellBase::OnFinishEffect(const AActor * caster)
 {
-	// Early exit, all spell should have some target
-	if (Targets.Num() == 0)
+	// NOTE(RyanC): Blueprints used to finish the effect themselves, ignore them if we already have.
+	if (GetSpellStep() == ESpellComponentCategory::NONE)
 	{
-		OnFinishEffect(player);
 		return;
 	}
 
-	CurrentSpellStep = ESpellComponentCategory::EFFECT;
-	StartEffect(player);
-}
+	RemainingPulses = 0;
+	SetSpellStep(ESpellComponentCategory::NONE);
 
-void UCG_SpellBase::OnFinishEffect(const ACG_PlayerCharacter * player)
-{
-	CurrentSpellStep = ESpellComponentCategory::NONE;
-	OnSpellComplete(player);
+	{
+		CG_SCOPE_BLUEPRINT_EVENT(Spell, OnSpellComplete);
+		OnSpellComplete(caster);
+	}
+
+	ReleaseEffects();
 
 	if (OnFinishedCastingDelegate.IsBound())
 	{
@@ -157,163 +212,184 @@ void UCG_SpellBase::OnFinishEffect(const ACG_PlayerCharacter * player)
 }
 
 // -----------------------------------------------------------------------------------------
-void UCG_SpellBase::AddTargetToSpell(FCG_SpellTarget & target)
+UNiagaraComponent * UCG_SpellBase::SpawnPooledEffect(UNiagaraSystem * system, FVector location, FRotator rotation)
 {
-	check(target.OwningActor.IsValid());
-	Targets.Emplace(target);
+	UWorld * world = GetWorld();
+	if (!system || !world)
+	{
+		return nullptr;
+	}
+
+	UCG_EffectPoolSubsystem * pool = world->GetSubsystem<UCG_EffectPoolSubsystem>();
+	check(pool);
+
+	UNiagaraComponent * effect = pool->AcquireEffect(system, location, rotation);
+	ActiveEffects.Emplace(effect);
+	return effect;
 }
 
 // -----------------------------------------------------------------------------------------
-void UCG_SpellBase::AddTargetToSpellWithImpactDir(UPARAM(ref) FCG_SpellTarget & target, FVector direction)
+UNiagaraComponent * UCG_SpellBase::SpawnBaseEffect(FVector location, FRotator rotation)
 {
-	target.ImpactDirection = direction;
-	AddTargetToSpell(target);
+	// NOTE(RyanC): Get() not LoadSynchronous(), a late effect is better than a hitch.
+	return SpawnPooledEffect(GetBaseComponent().BaseEffect.Get(), location, rotation);
 }
 
 // -----------------------------------------------------------------------------------------
-void UCG_SpellBase::UpdateSpell(float deltaTime, const ACG_PlayerCharacter * player)
+UDecalComponent * UCG_SpellBase::SpawnPooledDecal(UMaterialInterface * material, FVector location, FRotator rotation, FVector size)
 {
-	if (ShouldSpellCooldown())
+	UWorld * world = GetWorld();
+	if (!material || !world)
 	{
-		CurrentCooldown = FMath::Clamp(CurrentCooldown-deltaTime, 0.f, CurrentCooldown);
+		return nullptr;
 	}
 
-	switch (CurrentSpellStep)
+	UCG_EffectPoolSubsystem * pool = world->GetSubsystem<UCG_EffectPoolSubsystem>();
+	check(pool);
+
+	return pool->AcquireDecal(material, location, rotation, size);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::ReleaseEffects()
+{
+	if (ActiveEffects.Num() == 0)
 	{
-		case ESpellComponentCategory::TARGETING:
-		{
-			UpdateTargeting(deltaTime, player);
-		}
-		break;
+		return;
+	}
 
-		case ESpellComponentCategory::EFFECT:
+	UWorld * world = GetWorld();
+	UCG_EffectPoolSubsystem * pool = world ? world->GetSubsystem<UCG_EffectPoolSubsystem>() : nullptr;
+	if (pool)
+	{
+		for (UNiagaraComponent * effect : ActiveEffects)
 		{
-			UpdateEffect(deltaTime, player);
+			pool->ReleaseEffect(effect);
 		}
-		break;
 	}
+
+	ActiveEffects.Reset();
 }
 
 // -----------------------------------------------------------------------------------------
-bool UCG_SpellBase::HasComponentsInCategory(ESpellComponentCategory category, TArray<ESpellComponentType> & types) const
+void UCG_SpellBase::AddTargetToSpell(FCG_SpellTarget & target)
 {
-	switch(category)
+	AddTargetToSpellWithImpactDir(target, target.ImpactDirection);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::AddTargetToSpellWithImpactDir(UPARAM(ref) FCG_SpellTarget & target, FVector direction)
+{
+	check(target.OwningActor.IsValid());
+	check(TargetRegistry);
+
+	// NOTE(RyanC): Blueprints still pass whole targets around, only the owner is used to find the handle.
+	FCG_TargetHandle handle = TargetRegistry->FindHandle(target.OwningActor.Get());
+	if (!handle.IsSet())
 	{
-		case ESpellComponentCategory::TARGETING:
-		{
-			for (ESpellComponentType type : types)
-			{
-				bool hasType = false;
-				for (const FCG_SpellComponent & component : TargetingComponents)
-				{
-					if (component.Type == type)
-					{
-						hasType = true;
-						break;
-					}
-				}
-
-				if (!hasType) return false;
-			}
-		}
-		break;
+		UE_LOG(LogCelestialGrove, Warning, TEXT("Spell %s was given a target that isn't registered (%s)."), *GetName(), *target.OwningActor->GetName());
+		return;
+	}
+
+	target.ImpactDirection = direction;
+	AddTarget(handle, direction);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::AddTarget(const FCG_TargetHit & hit)
+{
+	check(hit.Handle.IsSet());
+	Targets.Emplace(hit);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::AddTarget(FCG_TargetHandle handle, const FVector & direction)
+{
+	check(handle.IsSet());
+	FCG_TargetHit & added = Targets.AddDefaulted_GetRef();
+	added.Handle = handle;
+	added.ImpactDirection = direction;
+}
 
+// -----------------------------------------------------------------------------------------
+void UCG_SpellBase::UpdateSpell(float deltaTime, const AActor * caster)
+{
+	// NOTE(RyanC): Cooldowns are scheduled by the runtime subsystem and targeting is native, so only
+	// continuous effects have anything to do per frame.
+	switch (GetSpellStep())
+	{
 		case ESpellComponentCategory::EFFECT:
 		{
-			for (ESpellComponentType type : types)
-			{
-				bool hasType = false;
-				for (const FCG_SpellComponent & component : EffectComponents)
-				{
-					if (component.Type == type)
-					{
-						hasType = true;
-						break;
-					}
-				}
-
-				if (!hasType) return false;
-			}
-		}
-		break;
+			CG_SCOPE_CYCLE_COUNTER(STAT_UpdateSpellEffect);
 
-		case ESpellComponentCategory::MODIFIERS:
-		{
-			for (ESpellComponentType type : types)
+			PulseTimer -= deltaTime;
+			if (RemainingPulses > 0 && PulseTimer <= 0.0f)
 			{
-				bool hasType = false;
-				for (const FCG_SpellComponent & component : ModifierComponents)
-				{
-					if (component.Type == type)
-					{
-						hasType = true;
-						break;
-					}
-				}
-
-				if (!hasType) return false;
+				RunEffectPulse(caster);
 			}
 		}
 		break;
 	}
-
-	return true;
 }
 
 // -----------------------------------------------------------------------------------------
-const FCG_SpellComponent & UCG_SpellBase::GetBaseComponent() const
+bool UCG_SpellBase::HasComponentsInCategory(ESpellComponentCategory category, TArray<ESpellComponentType> & types) const
 {
-	switch (BaseCategory)
+	uint16 typeMask = 0;
+	for (ESpellComponentType type : types)
 	{
-		case ESpellComponentCategory::TARGETING:
-		{
-			return TargetingComponents[0];
-		}
-		break;
+		SET_FLAG(typeMask, (uint16)(1 << (int32)type));
+	}
 
-		case ESpellComponentCategory::MODIFIERS:
-		{
-			return ModifierComponents[0];
-		}
-		break;
+	return HasComponentMaskInCategory(category, typeMask);
+}
 
-		default:
-			checkNoEntry();
+// -----------------------------------------------------------------------------------------
+const FCG_SpellComponent & UCG_SpellBase::GetBaseComponent() const
+{
+	check(CompiledSpell.IsValid());
+	return UCG_SpellComponentRegistry::Get()->GetComponentRow(CompiledSpell->BaseComponent);
+}
 
-		case ESpellComponentCategory::EFFECT:
-		{
-			return EffectComponents[0];
-		}
-		break;
-	}
+// -----------------------------------------------------------------------------------------
+const TArray<ESpellComponentType> & UCG_SpellBase::GetComponentsInCategory(ESpellComponentCategory category) const
+{
+	check(CompiledSpell.IsValid());
+	return CompiledSpell->GetComponentsInCategory(category);
 }
 
 // -----------------------------------------------------------------------------------------
 void UCG_SpellBase::ApplyDamageToTargets(int32 finalDamage) const
 {
-	for (const FCG_SpellTarget & target : Targets)
+	CG_SCOPE_CYCLE_COUNTER(STAT_ApplyDamageToTargets);
+
+	check(CombatCommands);
+	for (const FCG_TargetHit & hit : Targets)
 	{
-		check(target.ApplyDamageDelegate.IsBound());
-		target.ApplyDamageDelegate.Broadcast(finalDamage);
+		CombatCommands->PushDamage(hit.Handle, FMath::CeilToInt(finalDamage * hit.GetEffectScale()));
 	}
 }
 
 // -----------------------------------------------------------------------------------------
 void UCG_SpellBase::ApplyStatusToTargets(ECombatStatuses newStatus) const
 {
-	for (const FCG_SpellTarget & target : Targets)
+	CG_SCOPE_CYCLE_COUNTER(STAT_ApplyStatusToTargets);
+
+	check(CombatCommands);
+	for (const FCG_TargetHit & hit : Targets)
 	{
-		check(target.ApplyStatusDelegate.IsBound());
-		target.ApplyStatusDelegate.Broadcast((uint8)newStatus);
+		CombatCommands->PushStatus(hit.Handle, (uint8)newStatus);
 	}
 }
 
 // -----------------------------------------------------------------------------------------
 void UCG_SpellBase::ApplyForceToTargets(float strength) const
 {
-	for (const FCG_SpellTarget & target : Targets)
+	CG_SCOPE_CYCLE_COUNTER(STAT_ApplyForceToTargets);
+
+	check(CombatCommands);
+	for (const FCG_TargetHit & hit : Targets)
 	{
-		check(target.ApplyForceDelegate.IsBound());
-		target.ApplyForceDelegate.Broadcast(target.ImpactDirection, strength);
+		CombatCommands->PushForce(hit.Handle, hit.ImpactDirection, strength * hit.GetEffectScale());
 	}
 }
@@ -6,123 +6,24 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Engine/DataTable.h"
 #include "UObject/NoExportTypes.h"
 #include "CG_GlobalDefines.h"
+#include "CG_SpellTypes.h"
+#include "CG_CompiledSpell.h"
+#include "CG_SpellRuntimeSubsystem.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_CombatCommandSubsystem.h"
 #include "CG_SpellBase.generated.h"
 
 class AActor;
 class UNiagaraSystem;
-class USoundCue;
-struct FGuid;
-
-// ============================================================
-UENUM(BlueprintType)
-enum class ESpellComponentCategory : uint8
-{
-	NONE = 0, // NOTE(RyanC): This doesn't mean anything but going to use it for the spell's state machine
-	TARGETING,
-	EFFECT,
-	MODIFIERS
-};
-
-// ============================================================
-UENUM(BlueprintType)
-enum class ESpellComponentType : uint8
-{
-	// ============================================================
-	// Targeting Components
-	RADIUS_TARGETING = 0,
-	SELF_TARGETING,
-	FOREWARD_TARGETING,
-
-	// ============================================================
-	// Effect Components
-	FIRE_EFFECT,
-	TELEKINETIC_EFFECT,
-	ELECTRIC_EFFECT,
-
-	// ============================================================
-	// Modifier Components
-	AMPLIFY_MODIFIER,
-	INANIMATE_MODIFIER,
-	QUICK_MODIFIER,
-	CONTINUOUS_MODIFIER
-};
-
-#define RADIUS_AT_POINT_FLAG (1<<(int32)ESpellComponentType::RADIUS_TARGETING)
-#define TARGET_SELF_FLAG (1<<(int32)ESpellComponentType::SELF_TARGETING)
-#define PROJECTILE_FLAG (1<<(int32)ESpellComponentType::FOREWARD_TARGETING)
-#define RADIUS_AT_ORIGIN_FLAG ((1<<(int32)ESpellComponentType::RADIUS_TARGETING) | (1<<(int32)ESpellComponentType::SELF_TARGETING))
-#define BEAM_FLAG ((1<<(int32)ESpellComponentType::RADIUS_TARGETING) | (1<<(int32)ESpellComponentType::FOREWARD_TARGETING))
-#define SELF_FORWARD_FLAG ((1<<(int32)ESpellComponentType::FOREWARD_TARGETING) | (1<<(int32)ESpellComponentType::SELF_TARGETING))
-
-// ============================================================
-UENUM(BlueprintType)
-enum class ETargetingStyles : uint8
-{
-	RADIUS_AT_POINT = 0,
-	TARGET_SELF,
-	PROJECTILE,
-	RADIUS_AT_ORIGIN,
-	BEAM,
-	SELF_FORWARD,
-	CONE
-};
+class UNiagaraComponent;
+class UDecalComponent;
+class UMaterialInterface;
 
 // ============================================================
 DECLARE_MULTICAST_DELEGATE_OneParam(FSpellFinishedCastingSignature, UCG_SpellBase *);
-
-// ============================================================
-USTRUCT(BlueprintType)
-struct CELESTIALGROVE_API FCG_SpellComponent : public FTableRowBase
-{
-	GENERATED_BODY()
-	
-public:
-// ============================================================
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
-	FGuid GUID = FGuid::NewGuid();
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	ESpellComponentCategory Category;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	ESpellComponentType Type;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 BaseEffectStrength = 10;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float BaseTargetStrenth = 10.f;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float BaseCooldown = 1.0f;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float EffectModifier = 1.0f;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float TargetModifier = 1.0f;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float CooldownModifier = 1.0f;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FText Phonetic;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FText Description;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSoftObjectPtr<UTexture> Symbol;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSoftObjectPtr<UNiagaraSystem> BaseEffect;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSoftObjectPtr<USoundCue> BaseSfx;
-};
+DECLARE_MULTICAST_DELEGATE_OneParam(FSpellCooldownFinishedSignature, UCG_SpellBase *);
 
 // ============================================================
 UCLASS(Blueprintable)
@@ -130,21 +31,29 @@ class CELESTIALGROVE_API UCG_SpellBase : public UObject
 {
 	GENERATED_BODY()
 
+	friend class UCG_SpellRuntimeSubsystem;
+
 public:
 // ============================================================
 	UCG_SpellBase();
 
+	virtual void BeginDestroy() override;
+
 	UFUNCTION(BlueprintCallable)
 	void BuildSpell(UPARAM(ref) TArray<FCG_SpellComponent> & components);
 
 	UFUNCTION(BlueprintCallable)
-	void OnBeginCast(const ACG_PlayerCharacter * player);
+	void BuildSpellFromTypes(UPARAM(ref) TArray<ESpellComponentType> & components);
 
+	// Returns false if the spell's assets were still loading, the cast goes ahead either way.
 	UFUNCTION(BlueprintCallable)
-	void OnFinishTargeting(const ACG_PlayerCharacter * player);
+	bool OnBeginCast(const AActor * caster);
+
+	UFUNCTION(BlueprintCallable)
+	void OnFinishTargeting(const AActor * caster);
 	
 	UFUNCTION(BlueprintCallable)
-	void OnFinishEffect(const ACG_PlayerCharacter * player);
+	void OnFinishEffect(const AActor * caster);
 
 	UFUNCTION(BlueprintCallable)
 	void AddTargetToSpell(UPARAM(ref) FCG_SpellTarget & target);
@@ -153,7 +62,7 @@ public:
 	void AddTargetToSpellWithImpactDir(UPARAM(ref) FCG_SpellTarget & target, FVector direction);
 
 	UFUNCTION(BlueprintCallable)
-	void UpdateSpell(float deltaTime, const ACG_PlayerCharacter * player);
+	void UpdateSpell(float deltaTime, const AActor * caster);
 
 	UFUNCTION(BlueprintCallable)
 	bool HasComponentsInCategory(ESpellComponentCategory category, UPARAM(ref) TArray<ESpellComponentType> & types) const;
@@ -161,6 +70,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	const FCG_SpellComponent & GetBaseComponent() const;
 
+	UFUNCTION(BlueprintCallable)
+	const TArray<ESpellComponentType> & GetComponentsInCategory(ESpellComponentCategory category) const;
+
 	UFUNCTION(BlueprintCallable)
 	void ApplyDamageToTargets(int32 finalDamage) const;
 
@@ -176,62 +88,114 @@ public:
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE float GetSpellTargetStrength() const;
 	
+	UFUNCTION(BlueprintCallable)
+	bool AreSpellAssetsLoaded() const;
+
+	// Effects come from the world's effect pool and are handed back when the spell completes,
+	// don't destroy them.
+	UFUNCTION(BlueprintCallable)
+	UNiagaraComponent * SpawnPooledEffect(UNiagaraSystem * system, FVector location, FRotator rotation);
+
+	// Plays the base component's effect, does nothing if it hasn't finished loading
+	UFUNCTION(BlueprintCallable)
+	UNiagaraComponent * SpawnBaseEffect(FVector location, FRotator rotation);
+
+	UFUNCTION(BlueprintCallable)
+	UDecalComponent * SpawnPooledDecal(UMaterialInterface * material, FVector location, FRotator rotation, FVector size);
+
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool IsSpellOnCooldown() const;
 
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE bool ShouldSpellCooldown() const;
 
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE float GetRemainingCooldown() const;
+
 	UFUNCTION(BlueprintCallable)
 	FORCEINLINE ESpellComponentType GetEffectBase() const;
 
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE ETargetingStyles GetTargetingStyle() const;
+
+	FORCEINLINE bool HasComponentMaskInCategory(ESpellComponentCategory category, uint16 typeMask) const;
+	FORCEINLINE ESpellComponentCategory GetSpellStep() const;
+	FORCEINLINE ESpellCollisionType GetCollisionType() const;
+
+	FORCEINLINE float GetTargetingDistance() const;
+	FORCEINLINE float GetConeAngle() const;
+	FORCEINLINE float GetBeamRadius() const;
+	FORCEINLINE float GetProjectileSpeed() const;
+
+	// Same for every spell built from the same components, 0 until the spell is built
+	FORCEINLINE uint64 GetCompiledKey() const;
+
+	void AddTarget(const FCG_TargetHit & hit);
+	void AddTarget(FCG_TargetHandle handle, const FVector & direction);
+
 // ============================================================
 	FSpellFinishedCastingSignature OnFinishedCastingDelegate;
+	FSpellCooldownFinishedSignature OnCooldownFinishedDelegate;
 
 protected:
 // ============================================================
+	// Cosmetic only, targets are gathered natively based on the spell's targeting style.
 	UFUNCTION(BlueprintImplementableEvent)
-	void StartTargeting(const ACG_PlayerCharacter * player);
+	void StartTargeting(const AActor * caster);
 
+	// Cosmetic only, the effect program compiled from the components is what affects the targets.
 	UFUNCTION(BlueprintImplementableEvent)
-	void StartEffect(const ACG_PlayerCharacter * player);
+	void StartEffect(const AActor * caster);
 
 	UFUNCTION(BlueprintImplementableEvent)
-	void UpdateTargeting(float deltaTime, const ACG_PlayerCharacter * player);
+	void OnSpellComplete(const AActor * caster);
 
-	UFUNCTION(BlueprintImplementableEvent)
-	void UpdateEffect(float deltaTime, const ACG_PlayerCharacter * player);
-
-	UFUNCTION(BlueprintImplementableEvent)
-	void OnSpellComplete(const ACG_PlayerCharacter * player);
+// ============================================================
+	// How far traced, beam and point targeting reach
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Targeting")
+	float TargetingDistance;
 
-// ===========================================================
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Gameplay)
-	TArray<FCG_SpellComponent> TargetingComponents;
+	// Half angle of cone targeting (degrees)
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Targeting")
+	float ConeAngle;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Gameplay)
-	TArray<FCG_SpellComponent> EffectComponents;
+	// How wide the beam is at the end of its reach
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Targeting")
+	float BeamRadius;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Gameplay)
-	TArray<FCG_SpellComponent> ModifierComponents;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Targeting")
+	float ProjectileSpeed;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Gameplay)
-	ETargetingStyles TargetingStyle;
+	// Telekinetic effects push with effect strength * this
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Effect")
+	float ForceScale;
 
 private:
 // ============================================================
-	void BuildTargetingStyle();
+	void RegisterWithRuntime();
+	void SetSpellStep(ESpellComponentCategory step);
+	void RunEffectPulse(const AActor * caster);
+	void ReleaseEffects();
 
 // ============================================================
-	ESpellComponentCategory CurrentSpellStep;
-	ESpellComponentCategory BaseCategory;
+	// Shared with every other spell built from the same components, never modify through this.
+	FCG_CompiledSpellPtr CompiledSpell;
+
+	// Step and cooldown live in the runtime subsystem's arrays, this is our slot in them.
+	UCG_SpellRuntimeSubsystem * Runtime;
+	int32 RuntimeId;
+
+	// Targets are only handles, everything applied to them goes through here
+	const UCG_TargetRegistrySubsystem * TargetRegistry;
+	UCG_CombatCommandSubsystem * CombatCommands;
 
-	int32 SpellEffectStrength;
-	float SpellTargetStrength;
-	float SpellCooldown;
-	float CurrentCooldown;
+	int32 RemainingPulses;
+	float PulseTimer;
 
-	TArray<FCG_SpellTarget> Targets;
+	TArray<FCG_TargetHit> Targets;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UNiagaraComponent>> ActiveEffects;
 };
 
 // ============================================================
@@ -239,27 +203,82 @@ private:
 // -----------------------------------------------------------------------------------------
 FORCEINLINE int32 UCG_SpellBase::GetSpellEffectStrength() const
 {
-	return SpellEffectStrength;
+	check(CompiledSpell.IsValid());
+	return CompiledSpell->SpellEffectStrength;
 }
 // -----------------------------------------------------------------------------------------
 FORCEINLINE float UCG_SpellBase::GetSpellTargetStrength() const
 {
-	return SpellTargetStrength;
+	check(CompiledSpell.IsValid());
+	return CompiledSpell->SpellTargetStrength;
 }
 // -----------------------------------------------------------------------------------------
 FORCEINLINE bool UCG_SpellBase::IsSpellOnCooldown() const
 {
-	return (CurrentCooldown > 0.0f);
+	return (Runtime && Runtime->IsOnCooldown(RuntimeId));
 }
 // -----------------------------------------------------------------------------------------
 FORCEINLINE bool UCG_SpellBase::ShouldSpellCooldown() const
 {
-	return (IsSpellOnCooldown() && CurrentSpellStep == ESpellComponentCategory::NONE);
+	return (IsSpellOnCooldown() && GetSpellStep() == ESpellComponentCategory::NONE);
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_SpellBase::GetRemainingCooldown() const
+{
+	return Runtime ? Runtime->GetRemainingCooldown(RuntimeId) : 0.0f;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE ESpellComponentCategory UCG_SpellBase::GetSpellStep() const
+{
+	return Runtime ? Runtime->GetStep(RuntimeId) : ESpellComponentCategory::NONE;
 }
 // -----------------------------------------------------------------------------------------
 FORCEINLINE ESpellComponentType UCG_SpellBase::GetEffectBase() const
 {
-	check(EffectComponents.Num() > 0);
-	return EffectComponents[0].Type;
+	check(CompiledSpell.IsValid());
+	return CompiledSpell->EffectComponents[0];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE ETargetingStyles UCG_SpellBase::GetTargetingStyle() const
+{
+	check(CompiledSpell.IsValid());
+	return CompiledSpell->TargetingStyle;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE ESpellCollisionType UCG_SpellBase::GetCollisionType() const
+{
+	check(CompiledSpell.IsValid());
+	return CompiledSpell->CollisionType;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_SpellBase::GetTargetingDistance() const
+{
+	return TargetingDistance;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_SpellBase::GetConeAngle() const
+{
+	return ConeAngle;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_SpellBase::GetBeamRadius() const
+{
+	return BeamRadius;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_SpellBase::GetProjectileSpeed() const
+{
+	return ProjectileSpeed;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool UCG_SpellBase::HasComponentMaskInCategory(ESpellComponentCategory category, uint16 typeMask) const
+{
+	check(CompiledSpell.IsValid());
+	return CompiledSpell->HasComponentsInCategory(category, typeMask);
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE uint64 UCG_SpellBase::GetCompiledKey() const
+{
+	return CompiledSpell.IsValid() ? CompiledSpell->Key : 0;
 }
 // ============================================================
@@ -0,0 +1,119 @@
+// ============================================================
+// FILE: CG_SpellEffectProgram.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SpellEffectProgram.h"
+#include "CG_CombatCommandSubsystem.h"
+
+#define CONTINUOUS_PULSES_PER_MODIFIER 3
+#define CONTINUOUS_PULSE_INTERVAL 0.5f
+
+// -----------------------------------------------------------------------------------------
+void FCG_SpellEffectProgram::Compile(const TArray<ESpellComponentType> & effects, const TArray<ESpellComponentType> & modifiers, int32 effectStrength)
+{
+	Instructions.Reset();
+	PulseCount = 1;
+	PulseInterval = 0.0f;
+
+	// NOTE(RyanC): Amplify and quick are already folded into the strength and cooldown, the only
+	// modifier that changes the shape of the program is continuous.
+	for (ESpellComponentType modifier : modifiers)
+	{
+		if (modifier == ESpellComponentType::CONTINUOUS_MODIFIER)
+		{
+			PulseCount += CONTINUOUS_PULSES_PER_MODIFIER;
+			PulseInterval = CONTINUOUS_PULSE_INTERVAL;
+		}
+	}
+
+	for (ESpellComponentType effect : effects)
+	{
+		switch (effect)
+		{
+			case ESpellComponentType::FIRE_EFFECT:
+			{
+				Emit(ESpellEffectOp::DAMAGE, (float)effectStrength);
+				Emit(ESpellEffectOp::STATUS, 0.0f, (uint8)ECombatStatuses::ON_FIRE);
+			}
+			break;
+
+			case ESpellComponentType::ELECTRIC_EFFECT:
+			{
+				Emit(ESpellEffectOp::DAMAGE, (float)effectStrength);
+				Emit(ESpellEffectOp::STATUS, 0.0f, (uint8)ECombatStatuses::STUNNED);
+			}
+			break;
+
+			case ESpellComponentType::TELEKINETIC_EFFECT:
+			{
+				Emit(ESpellEffectOp::FORCE, (float)effectStrength);
+			}
+			break;
+
+			default:
+				checkNoEntry();
+		}
+	}
+
+	// Keep a fixed order so every spell emits its effects the same way. Where they land is up to the
+	// combat command flush: statuses and forces first, then all damage as one batch.
+	Instructions.StableSort([](const FCG_EffectInstruction & a, const FCG_EffectInstruction & b)
+	{
+		return a.Op < b.Op;
+	});
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_SpellEffectProgram::Emit(ESpellEffectOp op, float value, uint8 status)
+{
+	// Stacking the same effect just makes the one instruction stronger
+	for (FCG_EffectInstruction & instruction : Instructions)
+	{
+		if (instruction.Op == op)
+		{
+			instruction.Value += value;
+			SET_FLAG(instruction.Status, status);
+			return;
+		}
+	}
+
+	Instructions.Add({ op, status, value });
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_SpellEffectProgram::Execute(TArrayView<const FCG_TargetHit> hits, UCG_CombatCommandSubsystem & commands, float forceScale) const
+{
+	const FCG_EffectInstruction * begin = Instructions.GetData();
+	const FCG_EffectInstruction * end = begin + Instructions.Num();
+
+	// NOTE(RyanC): Stale handles are dropped when the buffer drains, the whole pulse lands together
+	// with statuses and forces before damage.
+	for (const FCG_TargetHit & hit : hits)
+	{
+		const float scale = hit.GetEffectScale();
+		for (const FCG_EffectInstruction * instruction = begin; instruction != end; ++instruction)
+		{
+			switch (instruction->Op)
+			{
+				case ESpellEffectOp::DAMAGE:
+				{
+					commands.PushDamage(hit.Handle, FMath::CeilToInt(instruction->Value * scale));
+				}
+				break;
+
+				case ESpellEffectOp::STATUS:
+				{
+					commands.PushStatus(hit.Handle, instruction->Status);
+				}
+				break;
+
+				case ESpellEffectOp::FORCE:
+				{
+					commands.PushForce(hit.Handle, hit.ImpactDirection, instruction->Value * forceScale * scale);
+				}
+				break;
+			}
+		}
+	}
+}
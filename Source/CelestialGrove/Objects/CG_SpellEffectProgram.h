@@ -0,0 +1,65 @@
+// ============================================================
+// FILE: CG_SpellEffectProgram.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CG_SpellTypes.h"
+
+class UCG_CombatCommandSubsystem;
+struct FCG_TargetHit;
+
+// ============================================================
+enum class ESpellEffectOp : uint8
+{
+	DAMAGE = 0,
+	STATUS,
+	FORCE
+};
+
+// ============================================================
+struct FCG_EffectInstruction
+{
+	ESpellEffectOp Op;
+	uint8 Status;
+	float Value;
+};
+
+static_assert(sizeof(FCG_EffectInstruction) == 8, "Effect instructions should stay tightly packed");
+
+// ============================================================
+// The effect and modifier components of a spell lowered into a flat list of instructions when
+// the spell is compiled, run natively over every target instead of going through blueprints.
+struct CELESTIALGROVE_API FCG_SpellEffectProgram
+{
+public:
+// ============================================================
+	void Compile(const TArray<ESpellComponentType> & effects, const TArray<ESpellComponentType> & modifiers, int32 effectStrength);
+	// Only pushes commands, nothing is applied until the command buffer is drained so this is
+	// safe to run off the game thread. Damage and force shrink with each hit's distance falloff.
+	void Execute(TArrayView<const FCG_TargetHit> hits, UCG_CombatCommandSubsystem & commands, float forceScale) const;
+
+	FORCEINLINE bool IsContinuous() const;
+
+// ============================================================
+	TArray<FCG_EffectInstruction, TInlineAllocator<4>> Instructions;
+
+	// How many times the program runs over the targets, and how long to wait between each run
+	int32 PulseCount;
+	float PulseInterval;
+
+private:
+// ============================================================
+	void Emit(ESpellEffectOp op, float value, uint8 status = 0);
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool FCG_SpellEffectProgram::IsContinuous() const
+{
+	return (PulseCount > 1);
+}
+// ============================================================
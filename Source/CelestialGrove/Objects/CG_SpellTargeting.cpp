@@ -0,0 +1,261 @@
+// ============================================================
+// FILE: CG_SpellTargeting.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SpellTargeting.h"
+#include "CG_SpellBase.h"
+#include "CG_PlayerCharacter.h"
+#include "CG_SceneQuerySubsystem.h"
+#include "CG_ProjectileSubsystem.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Targeting Overlap"), STAT_TargetingOverlap, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Targeting Radius At Point"), STAT_TargetRadiusAtPoint, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Targeting Self"), STAT_TargetSelf, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Targeting Projectile"), STAT_TargetProjectile, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Targeting Radius At Origin"), STAT_TargetRadiusAtOrigin, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Targeting Beam"), STAT_TargetBeam, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Targeting Self Forward"), STAT_TargetSelfForward, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Targeting Cone"), STAT_TargetCone, STATGROUP_CelestialGrove);
+
+// Reused by every overlap so big AoE casts don't allocate once it has grown, game thread only
+global TArray<FCG_TargetHit> GTargetingScratch;
+
+// -----------------------------------------------------------------------------------------
+internal void AddTargetsAndFinish(UCG_SpellBase & spell, const AActor * caster, TArrayView<const FCG_TargetHit> hits)
+{
+	for (const FCG_TargetHit & hit : hits)
+	{
+		spell.AddTarget(hit);
+	}
+
+	spell.OnFinishTargeting(caster);
+}
+
+// -----------------------------------------------------------------------------------------
+internal bool IsStillTargeting(const UCG_SpellBase * spell)
+{
+	// NOTE(RyanC): Query results show up a frame later, the spell could be gone or already finished by then.
+	return spell && spell->GetSpellStep() == ESpellComponentCategory::TARGETING;
+}
+
+// -----------------------------------------------------------------------------------------
+internal UCG_SceneQuerySubsystem * GetSceneQueries(const AActor * caster)
+{
+	UCG_SceneQuerySubsystem * queries = caster->GetWorld()->GetSubsystem<UCG_SceneQuerySubsystem>();
+	check(queries);
+	return queries;
+}
+
+// -----------------------------------------------------------------------------------------
+// Players aim with their camera, any other caster aims from its eyes.
+internal void GetCasterView(const AActor * caster, FVector & location, FVector & direction)
+{
+	const ACG_PlayerCharacter * player = Cast<ACG_PlayerCharacter>(caster);
+	if (player)
+	{
+		location = player->GetViewLocation();
+		direction = player->GetViewDirection();
+		return;
+	}
+
+	FRotator rotation;
+	caster->GetActorEyesViewPoint(location, rotation);
+	direction = rotation.Vector();
+}
+
+// -----------------------------------------------------------------------------------------
+internal bool FireProjectile(UCG_SpellBase & spell, const AActor * caster, const FVector & origin, const FVector & direction)
+{
+	UCG_ProjectileSubsystem * projectiles = caster->GetWorld()->GetSubsystem<UCG_ProjectileSubsystem>();
+	float speed = spell.GetProjectileSpeed();
+	if (!projectiles || speed <= 0.0f)
+	{
+		return false;
+	}
+
+	float lifetime = spell.GetTargetingDistance() / speed;
+	projectiles->SpawnProjectile(origin, direction.GetSafeNormal() * speed, lifetime, &spell, caster);
+	return true;
+}
+
+// -----------------------------------------------------------------------------------------
+// Finishes targeting with every registered target in a sphere around origin, optionally only
+// what falls inside a cone along forward.
+internal void OverlapAndFinish(UCG_SpellBase & spell, const AActor * caster, const FVector & origin, float radius, const FVector & forward = FVector::ZeroVector, float coneAngle = PI)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetingOverlap);
+
+	// NOTE(RyanC): The target registry answers these without touching the physics scene, so there's
+	// no reason to wait a frame on an async overlap.
+	const UCG_TargetRegistrySubsystem * registry = caster->GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	check(registry);
+
+	GTargetingScratch.Reset();
+	registry->GetTargetsInCone(spell.GetCollisionType(), origin, forward, radius, coneAngle, caster, GTargetingScratch);
+	AddTargetsAndFinish(spell, caster, GTargetingScratch);
+}
+
+// -----------------------------------------------------------------------------------------
+internal void TargetRadiusAtPoint(UCG_SpellBase & spell, const AActor * caster)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetRadiusAtPoint);
+
+	float distance = spell.GetTargetingDistance();
+	FVector start;
+	FVector direction;
+	GetCasterView(caster, start, direction);
+	FVector end = start + (direction * distance);
+
+	TWeakObjectPtr<UCG_SpellBase> weakSpell = &spell;
+	TWeakObjectPtr<const AActor> weakCaster = caster;
+
+	GetSceneQueries(caster)->RequestLineTrace(start, end, SPELL_TRACE_CHANNEL, caster, FCG_TraceQueryDelegate::CreateWeakLambda(&spell,
+		[weakSpell, weakCaster, end](bool wasHit, const FHitResult & hit)
+		{
+			UCG_SpellBase * spell = weakSpell.Get();
+			const AActor * caster = weakCaster.Get();
+			if (!IsStillTargeting(spell) || !caster)
+			{
+				return;
+			}
+
+			FVector point = wasHit ? FVector(hit.ImpactPoint) : end;
+			OverlapAndFinish(*spell, caster, point, spell->GetSpellTargetStrength());
+		}));
+}
+
+// -----------------------------------------------------------------------------------------
+internal void TargetSelf(UCG_SpellBase & spell, const AActor * caster)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetSelf);
+
+	const UCG_TargetRegistrySubsystem * registry = caster->GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	check(registry);
+
+	FCG_TargetHandle handle = registry->FindHandle(caster);
+	if (handle.IsSet())
+	{
+		spell.AddTarget(handle, caster->GetActorForwardVector());
+	}
+
+	spell.OnFinishTargeting(caster);
+}
+
+// -----------------------------------------------------------------------------------------
+internal void TargetProjectile(UCG_SpellBase & spell, const AActor * caster)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetProjectile);
+
+	FVector origin;
+	FVector direction;
+	GetCasterView(caster, origin, direction);
+
+	// NOTE(RyanC): Targeting finishes when the projectile hits something or runs out of lifetime.
+	if (!FireProjectile(spell, caster, origin, direction))
+	{
+		spell.OnFinishTargeting(caster);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+internal void TargetRadiusAtOrigin(UCG_SpellBase & spell, const AActor * caster)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetRadiusAtOrigin);
+
+	OverlapAndFinish(spell, caster, caster->GetActorLocation(), spell.GetSpellTargetStrength());
+}
+
+// -----------------------------------------------------------------------------------------
+internal void TargetBeam(UCG_SpellBase & spell, const AActor * caster)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetBeam);
+
+	// A beam is just a very narrow cone, wide enough to be BeamRadius across at the end
+	float distance = spell.GetTargetingDistance();
+	float angle = FMath::Atan2(spell.GetBeamRadius(), distance);
+
+	OverlapAndFinish(spell, caster, caster->GetActorLocation(), distance, caster->GetActorForwardVector(), angle);
+}
+
+// -----------------------------------------------------------------------------------------
+internal void TargetSelfForward(UCG_SpellBase & spell, const AActor * caster)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetSelfForward);
+
+	// Same as a projectile but fired along the body instead of the camera
+	if (!FireProjectile(spell, caster, caster->GetActorLocation(), caster->GetActorForwardVector()))
+	{
+		spell.OnFinishTargeting(caster);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+internal void TargetCone(UCG_SpellBase & spell, const AActor * caster)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetCone);
+
+	OverlapAndFinish(spell, caster, caster->GetActorLocation(), spell.GetSpellTargetStrength(), caster->GetActorForwardVector(), FMath::DegreesToRadians(spell.GetConeAngle()));
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_NativeTargetingFn GetNativeTargetingFunction(ETargetingStyles style)
+{
+	switch (style)
+	{
+		case ETargetingStyles::RADIUS_AT_POINT:
+			return &TargetRadiusAtPoint;
+
+		case ETargetingStyles::TARGET_SELF:
+			return &TargetSelf;
+
+		case ETargetingStyles::PROJECTILE:
+			return &TargetProjectile;
+
+		case ETargetingStyles::RADIUS_AT_ORIGIN:
+			return &TargetRadiusAtOrigin;
+
+		case ETargetingStyles::BEAM:
+			return &TargetBeam;
+
+		case ETargetingStyles::SELF_FORWARD:
+			return &TargetSelfForward;
+
+		case ETargetingStyles::CONE:
+			return &TargetCone;
+	}
+
+	checkNoEntry();
+	return nullptr;
+}
+
+// -----------------------------------------------------------------------------------------
+FCollisionObjectQueryParams GetSpellObjectQueryParams(ESpellCollisionType type)
+{
+	switch (type)
+	{
+		case ESpellCollisionType::INANIMATE_ONLY:
+			return FCollisionObjectQueryParams(INANIMATE_COLLISION_CHANNEL);
+
+		case ESpellCollisionType::ANIMATE_ONLY:
+			return FCollisionObjectQueryParams(ANIMATE_COLLISION_CHANNEL);
+
+		default:
+			return FCollisionObjectQueryParams(SPELL_TRACE_CHANNEL);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+bool MakeSpellTarget(const AActor * actor, ESpellCollisionType type, const FVector & origin, FCG_TargetHit & hit)
+{
+	if (!actor)
+	{
+		return false;
+	}
+
+	// Anything that registered as a target counts, blueprint subclasses included
+	const UCG_TargetRegistrySubsystem * registry = actor->GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	return registry && registry->FindTarget(actor, type, origin, hit);
+}
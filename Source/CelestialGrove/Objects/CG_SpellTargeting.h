@@ -0,0 +1,29 @@
+// ============================================================
+// FILE: CG_SpellTargeting.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "CG_GlobalDefines.h"
+#include "CG_SpellTypes.h"
+
+class AActor;
+class UCG_SpellBase;
+struct FCG_TargetHit;
+
+// ============================================================
+// Native targeting for a spell, run once when the targeting step starts. Either gathers the
+// targets and finishes targeting right away or hands off to something that will (projectiles).
+typedef void (*FCG_NativeTargetingFn)(UCG_SpellBase & spell, const AActor * caster);
+
+FCG_NativeTargetingFn GetNativeTargetingFunction(ETargetingStyles style);
+
+// ============================================================
+// Shared by everything that turns scene queries into spell targets
+FCollisionObjectQueryParams GetSpellObjectQueryParams(ESpellCollisionType type);
+
+// Finds the actor's target handle if the collision type allows it, impact direction points away from origin.
+bool MakeSpellTarget(const AActor * actor, ESpellCollisionType type, const FVector & origin, FCG_TargetHit & hit);
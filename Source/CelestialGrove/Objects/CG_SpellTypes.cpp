@@ -0,0 +1,17 @@
+// ============================================================
+// FILE: CG_SpellTypes.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SpellTypes.h"
+
+#if WITH_EDITOR
+// -----------------------------------------------------------------------------------------
+void FCG_SpellComponent::OnDataTableChanged(const UDataTable * dataTable, const FName rowName)
+{
+	if (!GUID.IsValid())
+	{
+		GUID = FGuid::NewGuid();
+	}
+}
+#endif // WITH_EDITOR
@@ -0,0 +1,161 @@
+// ============================================================
+// FILE: CG_SpellTypes.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "CG_GlobalDefines.h"
+#include "CG_SpellCore.h"
+#include "CG_SpellTypes.generated.h"
+
+class UNiagaraSystem;
+class USoundCue;
+class UTexture;
+
+// ============================================================
+UENUM(BlueprintType)
+enum class ESpellComponentCategory : uint8
+{
+	NONE = 0, // NOTE(RyanC): This doesn't mean anything but going to use it for the spell's state machine
+	TARGETING,
+	EFFECT,
+	MODIFIERS
+};
+
+#define SPELL_COMPONENT_CATEGORY_COUNT ((int32)ESpellComponentCategory::MODIFIERS + 1)
+
+// ============================================================
+UENUM(BlueprintType)
+enum class ESpellComponentType : uint8
+{
+	// ============================================================
+	// Targeting Components
+	RADIUS_TARGETING = 0,
+	SELF_TARGETING,
+	FOREWARD_TARGETING,
+
+	// ============================================================
+	// Effect Components
+	FIRE_EFFECT,
+	TELEKINETIC_EFFECT,
+	ELECTRIC_EFFECT,
+
+	// ============================================================
+	// Modifier Components
+	AMPLIFY_MODIFIER,
+	INANIMATE_MODIFIER,
+	QUICK_MODIFIER,
+	CONTINUOUS_MODIFIER
+};
+
+#define SPELL_COMPONENT_TYPE_COUNT ((int32)ESpellComponentType::CONTINUOUS_MODIFIER + 1)
+
+// ============================================================
+UENUM(BlueprintType)
+enum class ETargetingStyles : uint8
+{
+	RADIUS_AT_POINT = 0,
+	TARGET_SELF,
+	PROJECTILE,
+	RADIUS_AT_ORIGIN,
+	BEAM,
+	SELF_FORWARD,
+	CONE
+};
+
+// NOTE(RyanC): The spell algebra in CG_SpellCore.h has its own copy of these without the engine,
+// the values are cast straight across so they have to stay in the same order.
+static_assert(SPELL_COMPONENT_CATEGORY_COUNT == CG_CORE_COMPONENT_CATEGORY_COUNT, "Spell component categories don't match the core");
+static_assert(SPELL_COMPONENT_TYPE_COUNT == CG_CORE_COMPONENT_TYPE_COUNT, "Spell component types don't match the core");
+static_assert((int32)ESpellComponentType::FIRE_EFFECT == (int32)CGCore::EComponentType::FIRE_EFFECT, "Spell component types don't match the core");
+static_assert((int32)ESpellComponentType::AMPLIFY_MODIFIER == (int32)CGCore::EComponentType::AMPLIFY_MODIFIER, "Spell component types don't match the core");
+static_assert((int32)ESpellComponentType::INANIMATE_MODIFIER == (int32)CGCore::EComponentType::INANIMATE_MODIFIER, "Spell component types don't match the core");
+static_assert((int32)ETargetingStyles::CONE == (int32)CGCore::ETargetingStyle::CONE, "Targeting styles don't match the core");
+static_assert((int32)ETargetingStyles::BEAM == (int32)CGCore::ETargetingStyle::BEAM, "Targeting styles don't match the core");
+
+// ============================================================
+UENUM(BlueprintType)
+enum class ESpellCollisionType : uint8
+{
+	ALL = 0,
+	INANIMATE_ONLY,
+	ANIMATE_ONLY
+};
+
+// ============================================================
+USTRUCT(BlueprintType)
+struct CELESTIALGROVE_API FCG_SpellComponent : public FTableRowBase
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+#if WITH_EDITOR
+	virtual void OnDataTableChanged(const UDataTable * dataTable, const FName rowName) override;
+#endif // WITH_EDITOR
+
+// ============================================================
+	// NOTE(RyanC): Only generated for rows in the editor, a default initializer here would run the
+	// guid generator on every copy of a component.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	FGuid GUID;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ESpellComponentCategory Category;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	ESpellComponentType Type;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 BaseEffectStrength = 10;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BaseTargetStrenth = 10.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BaseCooldown = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float EffectModifier = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TargetModifier = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CooldownModifier = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FText Phonetic;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FText Description;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<UTexture> Symbol;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<UNiagaraSystem> BaseEffect;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<USoundCue> BaseSfx;
+};
+
+// ============================================================
+// Just the parts of a component row gameplay reads. The text and asset references stay in the
+// data table and are only looked up when the UI asks for them.
+struct FCG_SpellComponentStats
+{
+	ESpellComponentCategory Category = ESpellComponentCategory::NONE;
+	ESpellComponentType Type = ESpellComponentType::RADIUS_TARGETING;
+
+	int32 BaseEffectStrength = 10;
+	float BaseTargetStrength = 10.f;
+	float BaseCooldown = 1.0f;
+
+	float EffectModifier = 1.0f;
+	float TargetModifier = 1.0f;
+	float CooldownModifier = 1.0f;
+};
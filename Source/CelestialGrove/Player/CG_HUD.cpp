@@ -0,0 +1,135 @@
+// ============================================================
+// FILE: CG_HUD.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_HUD.h"
+#include "CG_GlobalDefines.h"
+#include "CG_HealthBarSubsystem.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "GameFramework/PlayerController.h"
+#include "Blueprint/WidgetLayoutLibrary.h"
+#include "Widgets/SInvalidationPanel.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Health Bar Update"), STAT_HealthBarUpdate, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Health Bars Drawn"), STAT_NumHealthBars, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Health Bar Repaints"), STAT_HealthBarRepaints, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+ACG_HUD::ACG_HUD()
+{
+	// Late so the bars are projected from where everything ended up this frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	HealthBarSize = FVector2D(80.0f, 8.0f);
+	HealthBarBackgroundColor = FLinearColor(0.0f, 0.0f, 0.0f, 0.6f);
+	HealthBarFillColor = FLinearColor(0.8f, 0.1f, 0.1f, 1.0f);
+
+	DrawnRevision = 0;
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_HUD::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UGameViewportClient * viewport = GetWorld()->GetGameViewport();
+	if (!viewport || !PlayerOwner || !PlayerOwner->GetLocalPlayer())
+	{
+		return;
+	}
+
+	// NOTE(RyanC): The invalidation panel keeps the layer's last paint cached, it's only redrawn
+	// when the layer invalidates itself from SetBars.
+	HealthBarRoot = SNew(SInvalidationPanel)
+		[
+			SAssignNew(HealthBarLayer, SCG_HealthBarLayer)
+			.BarSize(HealthBarSize)
+			.BackgroundColor(HealthBarBackgroundColor)
+			.FillColor(HealthBarFillColor)
+		];
+
+	viewport->AddViewportWidgetForPlayer(PlayerOwner->GetLocalPlayer(), HealthBarRoot.ToSharedRef(), 0);
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_HUD::EndPlay(const EEndPlayReason::Type endPlayReason)
+{
+	UGameViewportClient * viewport = GetWorld()->GetGameViewport();
+	if (viewport && HealthBarRoot.IsValid() && PlayerOwner && PlayerOwner->GetLocalPlayer())
+	{
+		viewport->RemoveViewportWidgetForPlayer(PlayerOwner->GetLocalPlayer(), HealthBarRoot.ToSharedRef());
+	}
+
+	HealthBarLayer.Reset();
+	HealthBarRoot.Reset();
+
+	Super::EndPlay(endPlayReason);
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_HUD::Tick(float deltaTime)
+{
+	Super::Tick(deltaTime);
+
+	if (HealthBarLayer.IsValid())
+	{
+		UpdateHealthBars();
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_HUD::UpdateHealthBars()
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_HealthBarUpdate);
+
+	const UCG_HealthBarSubsystem * bars = GetWorld()->GetSubsystem<UCG_HealthBarSubsystem>();
+	check(bars);
+
+	// Projection is in viewport pixels, the layer is in slate units
+	const float scale = UWidgetLayoutLibrary::GetViewportScale(this);
+	const float invScale = (scale > 0.0f) ? 1.0f / scale : 1.0f;
+	const FVector2D anchor(HealthBarSize.X * 0.5f, HealthBarSize.Y);
+
+	PendingBars.Reset();
+	for (int32 i = 0; i < bars->GetNumBars(); ++i)
+	{
+		if (!bars->GetOwner(i))
+		{
+			continue;
+		}
+
+		FVector2D screen;
+		if (!PlayerOwner->ProjectWorldLocationToScreen(bars->GetWorldPosition(i), screen, true))
+		{
+			continue;
+		}
+
+		// Snapped to whole units so sub pixel jitter from an idle enemy doesn't count as movement
+		screen = (screen * invScale) - anchor;
+		screen.X = FMath::RoundToFloat(screen.X);
+		screen.Y = FMath::RoundToFloat(screen.Y);
+
+		PendingBars.Add({ screen, bars->GetFraction(i) });
+	}
+
+	bool changed = (bars->GetRevision() != DrawnRevision) || (PendingBars.Num() != DrawnBars.Num());
+	for (int32 i = 0; !changed && i < PendingBars.Num(); ++i)
+	{
+		changed = (PendingBars[i].Position != DrawnBars[i].Position);
+	}
+
+	CG_SET_DWORD_STAT(STAT_NumHealthBars, PendingBars.Num());
+	if (!changed)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_HealthBarRepaints);
+	Swap(DrawnBars, PendingBars);
+	DrawnRevision = bars->GetRevision();
+	HealthBarLayer->SetBars(DrawnBars);
+}
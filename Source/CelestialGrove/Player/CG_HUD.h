@@ -0,0 +1,55 @@
+// ============================================================
+// FILE: CG_HUD.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "SCG_HealthBarLayer.h"
+#include "CG_HUD.generated.h"
+
+class SWidget;
+
+// ============================================================
+// Owns the screen space layers drawn over the game for its player. Health bars for every enemy
+// in the health bar subsystem are projected here once a frame and only handed to the layer when
+// a value or a bar's on screen position changes.
+UCLASS()
+class CELESTIALGROVE_API ACG_HUD : public AHUD
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	ACG_HUD();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
+	virtual void Tick(float deltaTime) override;
+
+protected:
+// ============================================================
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Health Bars")
+	FVector2D HealthBarSize;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Health Bars")
+	FLinearColor HealthBarBackgroundColor;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay|Health Bars")
+	FLinearColor HealthBarFillColor;
+
+private:
+// ============================================================
+	void UpdateHealthBars();
+
+// ============================================================
+	TSharedPtr<SWidget> HealthBarRoot;
+	TSharedPtr<SCG_HealthBarLayer> HealthBarLayer;
+
+	// What the layer is currently drawing, and next frame's bars built up to compare against it
+	TArray<FCG_HealthBarDraw> DrawnBars;
+	TArray<FCG_HealthBarDraw> PendingBars;
+	uint32 DrawnRevision;
+};
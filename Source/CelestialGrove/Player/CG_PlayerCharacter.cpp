@@ -11,6 +11,15 @@
 #include "CG_EnemyCharacter.h"
 #include "GameFramework/PlayerController.h"
 #include "CG_SpellBase.h"
+#include "CG_ProjectileSubsystem.h"
+#include "CG_SpellTargeting.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_StatusSubsystem.h"
+#include "CG_CombatStateSubsystem.h"
+#include "CG_SessionRecorderSubsystem.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Inspection Tick"), STAT_InspectionTick, STATGROUP_CelestialGrove);
 
 // -----------------------------------------------------------------------------------------
 ACG_PlayerCharacter::ACG_PlayerCharacter()
@@ -49,6 +58,8 @@ ACG_PlayerCharacter::ACG_PlayerCharacter()
 	MovementSpeed = 120.f;
 
 	ActiveSpell = 0;
+	CombatId = INDEX_NONE;
+	SessionRecorder = nullptr;
 }
 
 // -----------------------------------------------------------------------------------------
@@ -60,6 +71,31 @@ void ACG_PlayerCharacter::BeginPlay()
 	Target.ApplyDamageDelegate.AddUObject(this, &ACG_PlayerCharacter::ApplyDamage);
 	Target.ApplyStatusDelegate.AddUObject(this, &ACG_PlayerCharacter::ApplyStatus);
 	Target.ApplyForceDelegate.AddUObject(this, &ACG_PlayerCharacter::ApplyForce);
+
+	// NOTE(RyanC): Registered like any other target so self targeted spells can hold a handle to us,
+	// native area targeting skips the caster.
+	TargetHandle = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>()->RegisterTarget(this, &Target, ESpellTargetKind::ANIMATE, GetCapsuleComponent());
+	CombatId = GetWorld()->GetSubsystem<UCG_CombatStateSubsystem>()->RegisterCombatant(TargetHandle, Stats,
+		FCG_CombatEventDelegate::CreateUObject(this, &ACG_PlayerCharacter::OnCombatEvent));
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_PlayerCharacter::EndPlay(const EEndPlayReason::Type endPlayReason)
+{
+	UCG_CombatStateSubsystem * combatState = GetWorld()->GetSubsystem<UCG_CombatStateSubsystem>();
+	if (combatState && CombatId != INDEX_NONE)
+	{
+		combatState->UnregisterCombatant(CombatId);
+		CombatId = INDEX_NONE;
+	}
+
+	UCG_TargetRegistrySubsystem * registry = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	if (registry)
+	{
+		registry->UnregisterTarget(this);
+	}
+
+	Super::EndPlay(endPlayReason);
 }
 
 // -----------------------------------------------------------------------------------------
@@ -67,6 +103,21 @@ void ACG_PlayerCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInput
 {
 	Super::SetupPlayerInputComponent(PlayerInputComponent);
 
+	// NOTE(RyanC): Only the locally controlled player gets here, that's who sessions are recorded from.
+	// The recorder only exists when recording or playing back.
+	UCG_SessionRecorderSubsystem * recorder = GetWorld()->GetSubsystem<UCG_SessionRecorderSubsystem>();
+	if (recorder)
+	{
+		recorder->RegisterPlayer(this);
+		SessionRecorder = recorder->IsRecording() ? recorder : nullptr;
+
+		// Playback calls the input events itself, device input would only fight it
+		if (recorder->IsPlayingBack())
+		{
+			return;
+		}
+	}
+
 	PlayerInputComponent->BindAction("Interact", IE_Pressed, this, &ACG_PlayerCharacter::Interact);
 	PlayerInputComponent->BindAction("CastSpell", IE_Pressed, this, &ACG_PlayerCharacter::CastSpell);
 
@@ -82,16 +133,15 @@ void ACG_PlayerCharacter::Tick(float deltaTime)
 {
 	Super::Tick(deltaTime);
 
-	for (int32 i = 0; i < EquippedSpells.Num(); ++i)
-	{
-		EquippedSpells[i]->UpdateSpell(deltaTime, this);
-	}
+	// NOTE(RyanC): Equipped spells are updated by the spell runtime subsystem along with everyone else's.
 
 	switch(CurrentState)
 	{
 		// ============================================================
 		case EPlayerState::INSPECTING:
 		{
+			CG_SCOPE_CYCLE_COUNTER(STAT_InspectionTick);
+
 			checkf(InspectionTarget, TEXT("In inspection state without a valid inspection target!"));
 			FVector anchorPos = InspectionAnchorPoint->GetComponentLocation();
 
@@ -169,92 +219,64 @@ bool ACG_PlayerCharacter::TraceForCollision(FHitResult & result, float distance)
 }
 
 // -----------------------------------------------------------------------------------------
-bool ACG_PlayerCharacter::GetTargetsInSphere(ESpellCollisionType type, float radius, FVector & location, TArray<FCG_SpellTarget> & targets) const
+FVector ACG_PlayerCharacter::GetViewLocation() const
 {
-	TArray<FOverlapResult> overlaps;
-
-	FCollisionObjectQueryParams objParams;
-	switch(type)
-	{
-		case ESpellCollisionType::ALL:
-			objParams = FCollisionObjectQueryParams(SPELL_TRACE_CHANNEL);
-		break;
-
-		case ESpellCollisionType::INANIMATE_ONLY:
-			objParams = FCollisionObjectQueryParams(INANIMATE_COLLISION_CHANNEL);
-		break;
-
-		case ESpellCollisionType::ANIMATE_ONLY:
-			objParams = FCollisionObjectQueryParams(ANIMATE_COLLISION_CHANNEL);
-		break;
-	}
-
-	FCollisionShape shape {};
-	shape.SetSphere(radius);
+	return FirstPersonCamera->GetComponentLocation();
+}
 
-	FCollisionQueryParams params = FCollisionQueryParams::DefaultQueryParam;
-	params.TraceTag = TEXT("Interaction Trace");
-	params.OwnerTag = GetFName(); 
-	params.AddIgnoredActor(this);
+// -----------------------------------------------------------------------------------------
+FVector ACG_PlayerCharacter::GetViewDirection() const
+{
+	return FirstPersonCamera->GetForwardVector();
+}
 
-	bool res = GetWorld()->OverlapMultiByObjectType(
-													overlaps,
-													location,
-													FQuat::Identity,
-													objParams,
-													shape,
-													params
-												   );
-	
-	if (res)
+// -----------------------------------------------------------------------------------------
+// Blueprints get full copies, native spells only ever hold the handles
+internal void CopySpellTargets(const UCG_TargetRegistrySubsystem & registry, const TArray<FCG_TargetHit> & hits, TArray<FCG_SpellTarget> & targets)
+{
+	targets.Reserve(targets.Num() + hits.Num());
+	for (const FCG_TargetHit & hit : hits)
 	{
-		for (const FOverlapResult & overlap : overlaps)
-		{
-			if ((type == ESpellCollisionType::ALL || type == ESpellCollisionType::INANIMATE_ONLY) &&
-				overlap.GetActor()->GetClass() == ACG_InteractableBase::StaticClass())
-			{
-				ACG_InteractableBase * interactable = Cast<ACG_InteractableBase>(overlap.GetActor());
-				interactable->Target.ImpactDirection = (interactable->GetCenterOfMass() - location);
-				interactable->Target.ImpactDirection.Normalize();
-
-				targets.Emplace(interactable->Target);
-			}
-			else if ((type == ESpellCollisionType::ALL || type == ESpellCollisionType::ANIMATE_ONLY) &&
-					overlap.GetActor()->GetClass() == ACG_EnemyCharacter::StaticClass())
-			{
-				ACG_EnemyCharacter * enemy = Cast<ACG_EnemyCharacter>(overlap.GetActor());
-				enemy->Target.ImpactDirection = (enemy->GetMesh()->GetCenterOfMass() - location);
-				enemy->Target.ImpactDirection.Normalize();
-
-				targets.Emplace(enemy->Target);
-			}
-		}
+		FCG_SpellTarget & target = targets.Emplace_GetRef(*registry.GetTarget(hit.Handle));
+		target.ImpactDirection = hit.ImpactDirection;
+		target.DistanceFalloff = hit.DistanceFalloff;
 	}
+}
+
+// -----------------------------------------------------------------------------------------
+bool ACG_PlayerCharacter::GetTargetsInSphere(ESpellCollisionType type, float radius, FVector & location, TArray<FCG_SpellTarget> & targets) const
+{
+	const UCG_TargetRegistrySubsystem * registry = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
 
-	return res;
+	TArray<FCG_TargetHit> hits;
+	registry->GetTargetsInSphere(type, location, radius, this, hits);
+	CopySpellTargets(*registry, hits, targets);
+	return hits.Num() > 0;
 }
 
 // -----------------------------------------------------------------------------------------
 bool ACG_PlayerCharacter::GetTargetsInCone(ESpellCollisionType type, float radius, float angle, TArray<FCG_SpellTarget> & targets) const
 {
-	FVector origin = GetActorLocation();
-	bool res = GetTargetsInSphere(type, radius, origin, targets);
+	const UCG_TargetRegistrySubsystem * registry = GetWorld()->GetSubsystem<UCG_TargetRegistrySubsystem>();
+
+	TArray<FCG_TargetHit> hits;
+	registry->GetTargetsInCone(type, GetActorLocation(), GetActorForwardVector(), radius, angle, this, hits);
+	CopySpellTargets(*registry, hits, targets);
+	return hits.Num() > 0;
+}
 
-	if (res)
+// -----------------------------------------------------------------------------------------
+bool ACG_PlayerCharacter::CreateProjectile(FVector origin, FVector direction, float speed, UCG_SpellBase * spell) const
+{
+	UCG_ProjectileSubsystem * projectiles = GetWorld()->GetSubsystem<UCG_ProjectileSubsystem>();
+	if (!spell || !projectiles || speed <= 0.0f)
 	{
-		for (uint32 i = targets.Num() - 1; i >= 0; --i)
-		{
-			FVector originToActor = targets[i].OwningActor->GetActorLocation() - origin;
-			originToActor.Normalize();
-			float dot = FVector::DotProduct(originToActor, GetActorForwardVector());
-			if (FMath::Acos(dot) > angle)
-			{
-				targets.RemoveAt(i);
-			}
-		}
+		return false;
 	}
 
-	return res;
+	float lifetime = spell->GetTargetingDistance() / speed;
+	projectiles->SpawnProjectile(origin, direction.GetSafeNormal() * speed, lifetime, spell, this);
+	return true;
 }
 
 // -----------------------------------------------------------------------------------------
@@ -266,23 +288,40 @@ void ACG_PlayerCharacter::SpellFinishedCasting(UCG_SpellBase * spell)
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::ApplyDamage(int32 damage)
 {
-	Stats.Health = FMath::Clamp(Stats.Health - damage, 0, Stats.Health);
-
-	if (Stats.Health <= 0)
-	{
-		OnDeath();
-	}
-	else
-	{
-		OnDamaged();
-	}
+	GetWorld()->GetSubsystem<UCG_CombatStateSubsystem>()->ApplyDamage(CombatId, damage);
 }
 
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::ApplyStatus(uint8 status)
 {
-	SET_FLAG(Stats.Status, status);
-	// TODO(RyanC): Need to figure out how statuses will work first.
+	GetWorld()->GetSubsystem<UCG_StatusSubsystem>()->ApplyStatus(TargetHandle, status);
+}
+
+// -----------------------------------------------------------------------------------------
+void ACG_PlayerCharacter::OnCombatEvent(ECombatEvent event, int32 health, uint8 status)
+{
+	Stats.Health = health;
+	Stats.Status = status;
+
+	switch (event)
+	{
+		case ECombatEvent::DAMAGED:
+		{
+			CG_SCOPE_BLUEPRINT_EVENT(Player, OnDamaged);
+			OnDamaged();
+		}
+		break;
+
+		case ECombatEvent::DIED:
+		{
+			CG_SCOPE_BLUEPRINT_EVENT(Player, OnDeath);
+			OnDeath();
+		}
+		break;
+
+		default:
+			break;
+	}
 }
 
 // -----------------------------------------------------------------------------------------
@@ -294,6 +333,11 @@ void ACG_PlayerCharacter::ApplyForce(FVector direction, float strength)
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::Interact()
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAction(ERecordedAction::INTERACT);
+	}
+
 	if (CurrentState == EPlayerState::DEFAULT)
 	{
 		FHitResult result;
@@ -328,12 +372,24 @@ void ACG_PlayerCharacter::Interact()
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::CastSpell()
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAction(ERecordedAction::CAST_SPELL);
+	}
+
 	if (!IsCastingDisabled() && EquippedSpells.Num() > ActiveSpell)
 	{
 		if (!EquippedSpells[ActiveSpell]->IsSpellOnCooldown())
 		{
-			EquippedSpells[ActiveSpell]->OnBeginCast(this);
+			// Spells are built by the inventory UI, playback needs to know what's equipped before the cast
+			if (SessionRecorder)
+			{
+				SessionRecorder->RecordSpellLoadout(ActiveSpell, EquippedSpells[ActiveSpell]);
+			}
+
+			// NOTE(RyanC): Bind first, most spells finish during OnBeginCast now that targeting and effects are native.
 			EquippedSpells[ActiveSpell]->OnFinishedCastingDelegate.AddUObject(this, &ACG_PlayerCharacter::SpellFinishedCasting);
+			EquippedSpells[ActiveSpell]->OnBeginCast(this);
 		}
 	}
 }
@@ -341,9 +397,16 @@ void ACG_PlayerCharacter::CastSpell()
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::StartInspectionRotation()
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAction(ERecordedAction::START_INSPECTION_DRAG);
+	}
+
 	if (CurrentState == EPlayerState::INSPECTING)
 	{
 		isDraggingForInspection = true;
+
+		CG_SCOPE_BLUEPRINT_EVENT(Player, UpdateCursor);
 		UpdateCursor(isDraggingForInspection);
 	}
 }
@@ -351,9 +414,16 @@ void ACG_PlayerCharacter::StartInspectionRotation()
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::StopInspectionRotation()
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAction(ERecordedAction::STOP_INSPECTION_DRAG);
+	}
+
 	if (CurrentState == EPlayerState::INSPECTING)
 	{
 		isDraggingForInspection = false;
+
+		CG_SCOPE_BLUEPRINT_EVENT(Player, UpdateCursor);
 		UpdateCursor(isDraggingForInspection);
 	}
 }
@@ -361,6 +431,11 @@ void ACG_PlayerCharacter::StopInspectionRotation()
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::MoveForward(float value)
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAxis(ERecordedAxis::MOVE_FORWARD, value);
+	}
+
 	if (value != 0.0f && !IsMovementDisabled())
 	{
 		AddMovementInput(GetActorForwardVector(), value);
@@ -370,6 +445,11 @@ void ACG_PlayerCharacter::MoveForward(float value)
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::MoveRight(float value)
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAxis(ERecordedAxis::MOVE_RIGHT, value);
+	}
+
 	if (value != 0.0f && !IsMovementDisabled())
 	{
 		AddMovementInput(GetActorRightVector(), value);
@@ -379,6 +459,11 @@ void ACG_PlayerCharacter::MoveRight(float value)
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::Turn(float rate)
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAxis(ERecordedAxis::TURN, rate);
+	}
+
 	if (rate != 0.0f && !IsMovementDisabled())
 	{
 		AddControllerYawInput(rate * MouseSensitivity.X);
@@ -392,6 +477,11 @@ void ACG_PlayerCharacter::Turn(float rate)
 // -----------------------------------------------------------------------------------------
 void ACG_PlayerCharacter::LookUp(float rate)
 {
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAxis(ERecordedAxis::LOOK_UP, rate);
+	}
+
 	if (rate != 0.0f && !IsMovementDisabled())
 	{
 		AddControllerPitchInput(rate * MouseSensitivity.Y);
@@ -422,11 +512,20 @@ void ACG_PlayerCharacter::InspectionEnded()
 	check(CurrentState == EPlayerState::INSPECTING);
 	check(InspectionTarget);
 
+	if (SessionRecorder)
+	{
+		SessionRecorder->RecordAction(ERecordedAction::QUIT_INSPECTION);
+	}
+
 	InputComponent->RemoveActionBinding("QuitInspection", IE_Pressed);
 	InputComponent->RemoveActionBinding("InspectionDrag", IE_Pressed);
 	InputComponent->RemoveActionBinding("InspectionDrag", IE_Released);
 
-	InspectionTarget->OnEndInspection(FirstPersonCamera->GetForwardVector(), ThrowStrength);
+	{
+		CG_SCOPE_BLUEPRINT_EVENT(Interactable, OnEndInspection);
+		InspectionTarget->OnEndInspection(FirstPersonCamera->GetForwardVector(), ThrowStrength);
+	}
+
 	InspectionTarget = nullptr;
 	CurrentState = EPlayerState::DEFAULT;
 
@@ -441,8 +540,16 @@ void ACG_PlayerCharacter::SetMouseCursorShown(bool isShown)
 	playerController->bShowMouseCursor = isShown;
 	playerController->bEnableClickEvents = isShown;
 	playerController->bEnableMouseOverEvents = isShown;
-	UpdateCursor(false);
-	ChangeHUD(CurrentState);
+
+	{
+		CG_SCOPE_BLUEPRINT_EVENT(Player, UpdateCursor);
+		UpdateCursor(false);
+	}
+
+	{
+		CG_SCOPE_BLUEPRINT_EVENT(Player, ChangeHUD);
+		ChangeHUD(CurrentState);
+	}
 
 	if (isShown)
 	{
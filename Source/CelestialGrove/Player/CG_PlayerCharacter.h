@@ -9,13 +9,15 @@
 #include "GameFramework/Character.h"
 #include "CG_GlobalDefines.h"
 #include "UObject/NoExportTypes.h"
-#include "CG_GlobalDefines.h"
+#include "CG_SpellTypes.h"
+#include "CG_CombatStateSubsystem.h"
 #include "CG_PlayerCharacter.generated.h"
 
 class UCameraComponent;
 class USceneComponent;
 class ACG_InteractableBase;
 class UCG_SpellBase;
+class UCG_SessionRecorderSubsystem;
 
 // ============================================================
 UENUM(BlueprintType)
@@ -27,26 +29,21 @@ enum class EPlayerState : uint8
 	PAUSED
 };
 
-// ============================================================
-UENUM(BlueprintType)
-enum class ESpellCollisionType : uint8
-{
-	ALL = 0,
-	INANIMATE_ONLY,
-	ANIMATE_ONLY
-};
-
 // ============================================================
 UCLASS()
 class CELESTIALGROVE_API ACG_PlayerCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	// Plays recorded sessions back through the input events
+	friend class UCG_SessionRecorderSubsystem;
+
 public:
 // ============================================================
 	ACG_PlayerCharacter();
 
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	virtual void Tick(float deltaTime) override;
 	void BeginInspection(ACG_InteractableBase * const interactable);
@@ -60,8 +57,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	bool GetTargetsInCone(ESpellCollisionType type, float radius, float angle, TArray<FCG_SpellTarget> & targets) const;
 
-	UFUNCTION(BlueprintImplementableEvent, BlueprintCallable)
-	bool CreateProjectile(FVector direction, float speed, UCG_SpellBase * spell);
+	// Projectiles live long enough to travel the spell's targeting distance
+	UFUNCTION(BlueprintCallable)
+	bool CreateProjectile(FVector origin, FVector direction, float speed, UCG_SpellBase * spell) const;
 
 	UFUNCTION(BlueprintCallable)
 	void SpellFinishedCasting(UCG_SpellBase * spell);
@@ -76,6 +74,9 @@ public:
 	void ApplyForce(FVector direction, float strength);
 
 	FORCEINLINE bool ShouldUpdatePlayer() const;
+	FORCEINLINE const FCG_SpellTarget & GetSpellTarget() const;
+	FVector GetViewLocation() const;
+	FVector GetViewDirection() const;
 
 protected:
 // ============================================================
@@ -101,6 +102,7 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = Gameplay)
 	EPlayerState CurrentState;
 
+	// Starting values, the live ones are in the combat state subsystem and mirrored back here
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Gameplay)
 	FCG_Stats Stats;
 
@@ -165,6 +167,7 @@ private:
 	// ============================================================
 	void InspectionEnded();
 	void SetMouseCursorShown(bool isShown);
+	void OnCombatEvent(ECombatEvent event, int32 health, uint8 status);
 
 	FORCEINLINE bool IsMovementDisabled() const;
 	FORCEINLINE bool IsMouseDisabled() const;
@@ -174,6 +177,12 @@ private:
 	FVector2D MouseDelta;
 	uint32 isDraggingForInspection:1;
 	uint8 ActiveSpell;
+
+	FCG_TargetHandle TargetHandle;
+	int32 CombatId;
+
+	// Only set while a session is being recorded
+	UCG_SessionRecorderSubsystem * SessionRecorder;
 };
 
 // ============================================================
@@ -185,6 +194,11 @@ FORCEINLINE bool ACG_PlayerCharacter::ShouldUpdatePlayer() const
 			CurrentState == EPlayerState::PAUSED);
 }
 // -----------------------------------------------------------------------------------------
+FORCEINLINE const FCG_SpellTarget & ACG_PlayerCharacter::GetSpellTarget() const
+{
+	return Target;
+}
+// -----------------------------------------------------------------------------------------
 FORCEINLINE bool ACG_PlayerCharacter::IsMovementDisabled() const
 {
 	return (CurrentState == EPlayerState::INVENTORY ||
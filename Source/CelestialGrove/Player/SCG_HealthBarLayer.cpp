@@ -0,0 +1,56 @@
+// ============================================================
+// FILE: SCG_HealthBarLayer.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "SCG_HealthBarLayer.h"
+#include "Styling/CoreStyle.h"
+#include "Rendering/DrawElements.h"
+
+// -----------------------------------------------------------------------------------------
+void SCG_HealthBarLayer::Construct(const FArguments & args)
+{
+	BarSize = args._BarSize;
+	BackgroundColor = args._BackgroundColor;
+	FillColor = args._FillColor;
+	Brush = FCoreStyle::Get().GetBrush("WhiteBrush");
+
+	SetVisibility(EVisibility::HitTestInvisible);
+}
+
+// -----------------------------------------------------------------------------------------
+void SCG_HealthBarLayer::SetBars(const TArray<FCG_HealthBarDraw> & bars)
+{
+	Bars = bars;
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+// -----------------------------------------------------------------------------------------
+int32 SCG_HealthBarLayer::OnPaint(const FPaintArgs & args, const FGeometry & allottedGeometry, const FSlateRect & cullingRect,
+	FSlateWindowElementList & outDrawElements, int32 layerId, const FWidgetStyle & widgetStyle, bool parentEnabled) const
+{
+	const int32 fillLayer = layerId + 1;
+
+	for (const FCG_HealthBarDraw & bar : Bars)
+	{
+		FSlateDrawElement::MakeBox(outDrawElements, layerId,
+			allottedGeometry.ToPaintGeometry(bar.Position, BarSize),
+			Brush, ESlateDrawEffect::None, BackgroundColor);
+
+		if (bar.Fraction > 0.0f)
+		{
+			FSlateDrawElement::MakeBox(outDrawElements, fillLayer,
+				allottedGeometry.ToPaintGeometry(bar.Position, FVector2D(BarSize.X * bar.Fraction, BarSize.Y)),
+				Brush, ESlateDrawEffect::None, FillColor);
+		}
+	}
+
+	return fillLayer;
+}
+
+// -----------------------------------------------------------------------------------------
+FVector2D SCG_HealthBarLayer::ComputeDesiredSize(float layoutScaleMultiplier) const
+{
+	// Fills whatever the viewport gives it, bars are placed absolutely
+	return FVector2D::ZeroVector;
+}
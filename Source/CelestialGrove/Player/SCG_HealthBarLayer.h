@@ -0,0 +1,64 @@
+// ============================================================
+// FILE: SCG_HealthBarLayer.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+
+// ============================================================
+struct FCG_HealthBarDraw
+{
+	// Top left of the bar in the layer's space
+	FVector2D Position;
+	float Fraction;
+};
+
+// ============================================================
+// Draws every health bar on screen as two boxes each from one packed array. Nothing is laid out
+// per bar, and it only repaints when SetBars is handed something new.
+class CELESTIALGROVE_API SCG_HealthBarLayer : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SCG_HealthBarLayer)
+		: _BarSize(FVector2D(80.0f, 8.0f))
+		, _BackgroundColor(FLinearColor(0.0f, 0.0f, 0.0f, 0.6f))
+		, _FillColor(FLinearColor(0.8f, 0.1f, 0.1f, 1.0f))
+	{}
+		SLATE_ARGUMENT(FVector2D, BarSize)
+		SLATE_ARGUMENT(FLinearColor, BackgroundColor)
+		SLATE_ARGUMENT(FLinearColor, FillColor)
+	SLATE_END_ARGS()
+
+// ============================================================
+	void Construct(const FArguments & args);
+
+	// Invalidates paint, the caller decides if anything actually changed
+	void SetBars(const TArray<FCG_HealthBarDraw> & bars);
+
+	FORCEINLINE const FVector2D & GetBarSize() const;
+
+	virtual int32 OnPaint(const FPaintArgs & args, const FGeometry & allottedGeometry, const FSlateRect & cullingRect,
+		FSlateWindowElementList & outDrawElements, int32 layerId, const FWidgetStyle & widgetStyle, bool parentEnabled) const override;
+	virtual FVector2D ComputeDesiredSize(float layoutScaleMultiplier) const override;
+
+private:
+// ============================================================
+	TArray<FCG_HealthBarDraw> Bars;
+
+	FVector2D BarSize;
+	FLinearColor BackgroundColor;
+	FLinearColor FillColor;
+	const FSlateBrush * Brush;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE const FVector2D & SCG_HealthBarLayer::GetBarSize() const
+{
+	return BarSize;
+}
+// ============================================================
@@ -0,0 +1,411 @@
+// ============================================================
+// FILE: CG_BenchmarkSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_BenchmarkSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_EnemyCharacter.h"
+#include "CG_InteractableBase.h"
+#include "CG_PlayerCharacter.h"
+#include "CG_SpellBase.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_CombatStateSubsystem.h"
+#include "CG_SpellRuntimeSubsystem.h"
+#include "CG_ProjectileSubsystem.h"
+#include "CG_RagdollSubsystem.h"
+#include "CG_PhysicsSleepSubsystem.h"
+#include "CG_StatusSubsystem.h"
+#include "CG_HealthBarSubsystem.h"
+#include "CG_SignificanceSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+global const TCHAR * GBenchmarkCounterNames[BENCHMARK_COUNTER_COUNT] =
+{
+	TEXT("Targets"),
+	TEXT("Combatants"),
+	TEXT("ActiveSpells"),
+	TEXT("Projectiles"),
+	TEXT("Ragdolls"),
+	TEXT("AwakeProps"),
+	TEXT("Burning"),
+	TEXT("HealthBars"),
+	TEXT("EnemiesNear"),
+	TEXT("EnemiesMid"),
+	TEXT("EnemiesFar"),
+	TEXT("EnemiesDormant")
+};
+
+// -----------------------------------------------------------------------------------------
+// Every benchmark spell is the targeting components for its style plus a fire effect, so the
+// effect side stays the same and only targeting changes between styles.
+internal void GetStyleComponents(ETargetingStyles style, TArray<ESpellComponentType> & components)
+{
+	switch (style)
+	{
+		case ETargetingStyles::RADIUS_AT_POINT:
+			components.Add(ESpellComponentType::RADIUS_TARGETING);
+			break;
+
+		case ETargetingStyles::TARGET_SELF:
+			components.Add(ESpellComponentType::SELF_TARGETING);
+			break;
+
+		case ETargetingStyles::PROJECTILE:
+			components.Add(ESpellComponentType::FOREWARD_TARGETING);
+			break;
+
+		case ETargetingStyles::RADIUS_AT_ORIGIN:
+			components.Add(ESpellComponentType::RADIUS_TARGETING);
+			components.Add(ESpellComponentType::SELF_TARGETING);
+			break;
+
+		case ETargetingStyles::BEAM:
+			components.Add(ESpellComponentType::RADIUS_TARGETING);
+			components.Add(ESpellComponentType::FOREWARD_TARGETING);
+			break;
+
+		case ETargetingStyles::SELF_FORWARD:
+			components.Add(ESpellComponentType::FOREWARD_TARGETING);
+			components.Add(ESpellComponentType::SELF_TARGETING);
+			break;
+
+		default:
+			components.Add(ESpellComponentType::RADIUS_TARGETING);
+			components.Add(ESpellComponentType::SELF_TARGETING);
+			components.Add(ESpellComponentType::FOREWARD_TARGETING);
+			break;
+	}
+
+	components.Add(ESpellComponentType::FIRE_EFFECT);
+}
+
+// -----------------------------------------------------------------------------------------
+UCG_BenchmarkSubsystem::UCG_BenchmarkSubsystem()
+{
+	EnemyClass = ACG_EnemyCharacter::StaticClass();
+	InteractableClass = ACG_InteractableBase::StaticClass();
+	CasterClass = ACG_PlayerCharacter::StaticClass();
+	SpellClass = UCG_SpellBase::StaticClass();
+
+	NumEnemies = 100;
+	NumInteractables = 200;
+	NumCasters = 4;
+	SpawnRadius = 4000.0f;
+	CastInterval = 0.5f;
+	WarmupFrames = 120;
+	MeasuredFrames = 1800;
+	RandomSeed = 1337;
+
+	TimeUntilCast = 0.0f;
+	FramesInPhase = 0;
+	Phase = EBenchmarkPhase::WAITING;
+
+	FMemory::Memzero(CounterSums);
+	FMemory::Memzero(CounterMaxes);
+	FMemory::Memzero(CastCounts);
+	FMemory::Memzero(SkippedCasts);
+	FMemory::Memzero(CastCycles);
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_BenchmarkSubsystem::ShouldCreateSubsystem(UObject * outer) const
+{
+	// NOTE(RyanC): -benchmark is the engine's own switch, it's what puts the game on a fixed time step
+	return FApp::IsBenchmarking() && Super::ShouldCreateSubsystem(outer);
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_BenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+	return worldType == EWorldType::Game;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_BenchmarkSubsystem::OnWorldBeginPlay(UWorld & world)
+{
+	Super::OnWorldBeginPlay(world);
+
+	const TCHAR * commandLine = FCommandLine::Get();
+	FParse::Value(commandLine, TEXT("benchmarkenemies="), NumEnemies);
+	FParse::Value(commandLine, TEXT("benchmarkprops="), NumInteractables);
+	FParse::Value(commandLine, TEXT("benchmarkcasters="), NumCasters);
+	FParse::Value(commandLine, TEXT("benchmarkframes="), MeasuredFrames);
+
+	if (!FParse::Value(commandLine, TEXT("benchmarkout="), OutputPath))
+	{
+		OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") /
+			FString::Printf(TEXT("%s_%s.json"), *world.GetMapName(), *FDateTime::Now().ToString());
+	}
+
+	SpawnScenario(world);
+
+	UE_LOG(LogCelestialGrove, Display, TEXT("Benchmark: %d enemies, %d props, %d casters on %s, %d warmup and %d measured frames."),
+		NumEnemies, NumInteractables, Casters.Num(), *world.GetMapName(), WarmupFrames, MeasuredFrames);
+
+	Phase = EBenchmarkPhase::WARMUP;
+	FramesInPhase = 0;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_BenchmarkSubsystem::Deinitialize()
+{
+	Casters.Empty();
+	Spells.Empty();
+	NextStyles.Empty();
+	Timings.Empty();
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_BenchmarkSubsystem::Tick(float deltaTime)
+{
+	Super::Tick(deltaTime);
+
+	// NOTE(RyanC): Sampled before the phase can change, the frame that ends warmup isn't measured
+	Timings.Sample(Phase == EBenchmarkPhase::MEASURING);
+
+	TimeUntilCast -= deltaTime;
+	if (TimeUntilCast <= 0.0f)
+	{
+		TimeUntilCast += CastInterval;
+		CastSpells();
+	}
+
+	++FramesInPhase;
+
+	if (Phase == EBenchmarkPhase::WARMUP)
+	{
+		if (FramesInPhase >= WarmupFrames)
+		{
+			Phase = EBenchmarkPhase::MEASURING;
+			FramesInPhase = 0;
+
+#if CSV_PROFILER
+			FCsvProfiler::Get()->BeginCapture(MeasuredFrames, FPaths::GetPath(OutputPath), FPaths::GetBaseFilename(OutputPath) + TEXT(".csv"));
+#endif
+		}
+
+		return;
+	}
+
+	SampleCounters();
+
+	if (FramesInPhase >= MeasuredFrames)
+	{
+		Phase = EBenchmarkPhase::DONE;
+		WriteResults();
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_BenchmarkSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_BenchmarkSubsystem::IsTickable() const
+{
+	return IsInitialized() && (Phase == EBenchmarkPhase::WARMUP || Phase == EBenchmarkPhase::MEASURING);
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_BenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_BenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_BenchmarkSubsystem::SpawnScenario(UWorld & world)
+{
+	FRandomStream random(RandomSeed);
+
+	// Around wherever the map put the player, the middle of the world otherwise
+	FVector center = FVector::ZeroVector;
+	APlayerController * playerController = world.GetFirstPlayerController();
+	if (playerController && playerController->GetPawn())
+	{
+		center = playerController->GetPawn()->GetActorLocation();
+	}
+
+	FActorSpawnParameters params;
+	params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	UClass * enemyClass = EnemyClass.LoadSynchronous();
+	UClass * interactableClass = InteractableClass.LoadSynchronous();
+	UClass * casterClass = CasterClass.LoadSynchronous();
+	UClass * spellClass = SpellClass.LoadSynchronous();
+	check(enemyClass && interactableClass && casterClass && spellClass);
+
+	for (int32 i = 0; i < NumEnemies; ++i)
+	{
+		const FVector2D offset = FVector2D(random.VRand()).GetSafeNormal() * SpawnRadius * FMath::Sqrt(random.FRand());
+		const FRotator rotation(0.0f, random.FRandRange(-180.0f, 180.0f), 0.0f);
+		world.SpawnActor<ACG_EnemyCharacter>(enemyClass, center + FVector(offset, 0.0f), rotation, params);
+	}
+
+	for (int32 i = 0; i < NumInteractables; ++i)
+	{
+		const FVector2D offset = FVector2D(random.VRand()).GetSafeNormal() * SpawnRadius * FMath::Sqrt(random.FRand());
+		world.SpawnActor<ACG_InteractableBase>(interactableClass, center + FVector(offset, 50.0f), FRotator::ZeroRotator, params);
+	}
+
+	TArray<ESpellComponentType> components;
+	for (int32 i = 0; i < NumCasters; ++i)
+	{
+		const float angle = (2.0f * PI * i) / NumCasters;
+		const FVector location = center + FVector(FMath::Cos(angle), FMath::Sin(angle), 0.0f) * SpawnRadius * 0.5f;
+		const FRotator facing = (center - location).Rotation();
+
+		ACG_PlayerCharacter * caster = world.SpawnActor<ACG_PlayerCharacter>(casterClass, location, facing, params);
+		if (!caster)
+		{
+			continue;
+		}
+
+		Casters.Emplace(caster);
+		NextStyles.Emplace(i % BENCHMARK_STYLE_COUNT);
+
+		for (int32 style = 0; style < BENCHMARK_STYLE_COUNT; ++style)
+		{
+			components.Reset();
+			GetStyleComponents((ETargetingStyles)style, components);
+
+			UCG_SpellBase * spell = NewObject<UCG_SpellBase>(caster, spellClass);
+			spell->BuildSpellFromTypes(components);
+			Spells.Emplace(spell);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_BenchmarkSubsystem::CastSpells()
+{
+	const bool isMeasuring = (Phase == EBenchmarkPhase::MEASURING);
+
+	for (int32 i = 0; i < Casters.Num(); ++i)
+	{
+		const int32 style = NextStyles[i];
+		NextStyles[i] = (style + 1) % BENCHMARK_STYLE_COUNT;
+
+		ACG_PlayerCharacter * caster = Casters[i];
+		UCG_SpellBase * spell = Spells[i * BENCHMARK_STYLE_COUNT + style];
+		if (!caster || spell->GetSpellStep() != ESpellComponentCategory::NONE || spell->IsSpellOnCooldown())
+		{
+			if (isMeasuring)
+			{
+				++SkippedCasts[style];
+			}
+
+			continue;
+		}
+
+		const uint64 startCycles = FPlatformTime::Cycles64();
+		spell->OnBeginCast(caster);
+
+		if (isMeasuring)
+		{
+			CastCycles[style] += FPlatformTime::Cycles64() - startCycles;
+			++CastCounts[style];
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_BenchmarkSubsystem::SampleCounters()
+{
+	UWorld * world = GetWorld();
+	const UCG_SignificanceSubsystem * significance = world->GetSubsystem<UCG_SignificanceSubsystem>();
+
+	int32 values[BENCHMARK_COUNTER_COUNT];
+	values[(int32)EBenchmarkCounter::TARGETS] = world->GetSubsystem<UCG_TargetRegistrySubsystem>()->GetNumTargets();
+	values[(int32)EBenchmarkCounter::COMBATANTS] = world->GetSubsystem<UCG_CombatStateSubsystem>()->GetNumCombatants();
+	values[(int32)EBenchmarkCounter::ACTIVE_SPELLS] = world->GetSubsystem<UCG_SpellRuntimeSubsystem>()->GetNumActiveSpells();
+	values[(int32)EBenchmarkCounter::PROJECTILES] = world->GetSubsystem<UCG_ProjectileSubsystem>()->GetNumProjectiles();
+	values[(int32)EBenchmarkCounter::RAGDOLLS] = world->GetSubsystem<UCG_RagdollSubsystem>()->GetNumRagdolls();
+	values[(int32)EBenchmarkCounter::AWAKE_PROPS] = world->GetSubsystem<UCG_PhysicsSleepSubsystem>()->GetNumAwakeBodies();
+	values[(int32)EBenchmarkCounter::BURNING] = world->GetSubsystem<UCG_StatusSubsystem>()->GetNumWithStatus(ETimedStatus::ON_FIRE);
+	values[(int32)EBenchmarkCounter::HEALTH_BARS] = world->GetSubsystem<UCG_HealthBarSubsystem>()->GetNumBars();
+	values[(int32)EBenchmarkCounter::ENEMIES_NEAR] = significance->GetNumInBucket(ESignificance::NEAR);
+	values[(int32)EBenchmarkCounter::ENEMIES_MID] = significance->GetNumInBucket(ESignificance::MID);
+	values[(int32)EBenchmarkCounter::ENEMIES_FAR] = significance->GetNumInBucket(ESignificance::FAR);
+	values[(int32)EBenchmarkCounter::ENEMIES_DORMANT] = significance->GetNumInBucket(ESignificance::DORMANT);
+
+	for (int32 i = 0; i < BENCHMARK_COUNTER_COUNT; ++i)
+	{
+		CounterSums[i] += values[i];
+		CounterMaxes[i] = FMath::Max(CounterMaxes[i], values[i]);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_BenchmarkSubsystem::WriteResults() const
+{
+	FString output;
+	TSharedRef<FCG_BenchmarkJsonWriter> writer = FCG_BenchmarkJsonWriter::Create(&output);
+
+	writer->WriteObjectStart();
+	writer->WriteValue(TEXT("map"), GetWorld()->GetMapName());
+	writer->WriteValue(TEXT("build"), LexToString(FApp::GetBuildConfiguration()));
+	writer->WriteValue(TEXT("fixedDeltaTime"), FApp::GetFixedDeltaTime());
+
+	writer->WriteObjectStart(TEXT("scenario"));
+	writer->WriteValue(TEXT("enemies"), NumEnemies);
+	writer->WriteValue(TEXT("interactables"), NumInteractables);
+	writer->WriteValue(TEXT("casters"), Casters.Num());
+	writer->WriteValue(TEXT("spawnRadius"), SpawnRadius);
+	writer->WriteValue(TEXT("castInterval"), CastInterval);
+	writer->WriteValue(TEXT("warmupFrames"), WarmupFrames);
+	writer->WriteValue(TEXT("measuredFrames"), Timings.GetNumFrames());
+	writer->WriteValue(TEXT("seed"), RandomSeed);
+	writer->WriteObjectEnd();
+
+	Timings.Write(*writer);
+
+	// Time inside OnBeginCast, native targeting included
+	const UEnum * styles = StaticEnum<ETargetingStyles>();
+	writer->WriteArrayStart(TEXT("casts"));
+	for (int32 i = 0; i < BENCHMARK_STYLE_COUNT; ++i)
+	{
+		writer->WriteObjectStart();
+		writer->WriteValue(TEXT("style"), styles->GetNameStringByValue(i));
+		writer->WriteValue(TEXT("casts"), CastCounts[i]);
+		writer->WriteValue(TEXT("skipped"), SkippedCasts[i]);
+		writer->WriteValue(TEXT("meanMs"), (CastCounts[i] > 0) ? FPlatformTime::ToMilliseconds64(CastCycles[i]) / CastCounts[i] : 0.0);
+		writer->WriteObjectEnd();
+	}
+	writer->WriteArrayEnd();
+
+	writer->WriteObjectStart(TEXT("counters"));
+	for (int32 i = 0; i < BENCHMARK_COUNTER_COUNT; ++i)
+	{
+		writer->WriteObjectStart(GBenchmarkCounterNames[i]);
+		writer->WriteValue(TEXT("mean"), (Timings.GetNumFrames() > 0) ? CounterSums[i] / Timings.GetNumFrames() : 0.0);
+		writer->WriteValue(TEXT("max"), CounterMaxes[i]);
+		writer->WriteObjectEnd();
+	}
+	writer->WriteObjectEnd();
+
+	writer->WriteObjectEnd();
+	writer->Close();
+
+	if (FFileHelper::SaveStringToFile(output, *OutputPath))
+	{
+		UE_LOG(LogCelestialGrove, Display, TEXT("Benchmark results written to %s"), *OutputPath);
+	}
+	else
+	{
+		UE_LOG(LogCelestialGrove, Error, TEXT("Couldn't write benchmark results to %s"), *OutputPath);
+	}
+}
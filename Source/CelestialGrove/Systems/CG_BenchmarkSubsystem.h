@@ -0,0 +1,150 @@
+// ============================================================
+// FILE: CG_BenchmarkSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_SpellTypes.h"
+#include "CG_FrameTimings.h"
+#include "CG_BenchmarkSubsystem.generated.h"
+
+class ACG_EnemyCharacter;
+class ACG_InteractableBase;
+class ACG_PlayerCharacter;
+class UCG_SpellBase;
+
+// ============================================================
+// Sampled every measured frame, written out with their mean and max
+enum class EBenchmarkCounter : uint8
+{
+	TARGETS = 0,
+	COMBATANTS,
+	ACTIVE_SPELLS,
+	PROJECTILES,
+	RAGDOLLS,
+	AWAKE_PROPS,
+	BURNING,
+	HEALTH_BARS,
+	ENEMIES_NEAR,
+	ENEMIES_MID,
+	ENEMIES_FAR,
+	ENEMIES_DORMANT
+};
+
+#define BENCHMARK_COUNTER_COUNT ((int32)EBenchmarkCounter::ENEMIES_DORMANT + 1)
+#define BENCHMARK_STYLE_COUNT ((int32)ETargetingStyles::CONE + 1)
+
+// ============================================================
+enum class EBenchmarkPhase : uint8
+{
+	WAITING = 0,
+	WARMUP,
+	MEASURING,
+	DONE
+};
+
+// ============================================================
+// Only exists when the game is started with -benchmark, which also puts the engine on a fixed
+// time step so every run simulates the same frames. Fills whatever map was loaded with enemies,
+// props and casters, has every caster cycle through a spell of each targeting style and writes
+// frame times and per system counters out as JSON once it's done, then quits.
+//
+//   CelestialGrove <Map> -game -nullrhi -nosound -unattended -benchmark [-benchmarkout=<file>]
+//   [-benchmarkenemies=N] [-benchmarkprops=N] [-benchmarkcasters=N] [-benchmarkframes=N]
+//
+// Per scope timings go to a CSV capture over the same frames when the CSV profiler is compiled in.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_BenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_BenchmarkSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject * outer) const override;
+	virtual void OnWorldBeginPlay(UWorld & world) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+// ============================================================
+	virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+// ============================================================
+	UPROPERTY(Config)
+	TSoftClassPtr<ACG_EnemyCharacter> EnemyClass;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<ACG_InteractableBase> InteractableClass;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<ACG_PlayerCharacter> CasterClass;
+
+	UPROPERTY(Config)
+	TSoftClassPtr<UCG_SpellBase> SpellClass;
+
+	UPROPERTY(Config)
+	int32 NumEnemies;
+
+	UPROPERTY(Config)
+	int32 NumInteractables;
+
+	UPROPERTY(Config)
+	int32 NumCasters;
+
+	// Enemies and props are scattered inside this, casters stand on a ring half as wide facing the middle
+	UPROPERTY(Config)
+	float SpawnRadius;
+
+	// Every caster starts its next spell this often (game time), if the last one is finished
+	UPROPERTY(Config)
+	float CastInterval;
+
+	UPROPERTY(Config)
+	int32 WarmupFrames;
+
+	UPROPERTY(Config)
+	int32 MeasuredFrames;
+
+	UPROPERTY(Config)
+	int32 RandomSeed;
+
+private:
+// ============================================================
+	void SpawnScenario(UWorld & world);
+	void CastSpells();
+	void SampleCounters();
+	void WriteResults() const;
+
+// ============================================================
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ACG_PlayerCharacter>> Casters;
+
+	// BENCHMARK_STYLE_COUNT per caster, caster major
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UCG_SpellBase>> Spells;
+
+	TArray<int32> NextStyles;
+
+	FCG_FrameTimings Timings;
+
+	double CounterSums[BENCHMARK_COUNTER_COUNT];
+	int32 CounterMaxes[BENCHMARK_COUNTER_COUNT];
+
+	int32 CastCounts[BENCHMARK_STYLE_COUNT];
+	int32 SkippedCasts[BENCHMARK_STYLE_COUNT];
+	uint64 CastCycles[BENCHMARK_STYLE_COUNT];
+
+	FString OutputPath;
+	float TimeUntilCast;
+	int32 FramesInPhase;
+	EBenchmarkPhase Phase;
+};
+// ============================================================
@@ -0,0 +1,267 @@
+// ============================================================
+// FILE: CG_CombatCommandSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_CombatCommandSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Combat Command Drain"), STAT_CombatCommandDrain, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Commands Pushed"), STAT_CombatCommandsPushed, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Commands Applied"), STAT_CombatCommandsApplied, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Combat Commands Overflowed"), STAT_CombatCommandsOverflowed, STATGROUP_CelestialGrove);
+
+// Every subsystem instance gets its own id, 0 is never handed out
+global std::atomic<uint32> GNextCommandRingOwner { 1 };
+
+// The ring this thread last pushed into and which subsystem it belongs to. Weak so a world going
+// away frees its rings, a push that's still in flight keeps its ring alive until it's done.
+struct FCG_ThreadCommandRing
+{
+	uint32 OwnerId = 0;
+	TWeakPtr<FCG_CombatCommandRing, ESPMode::ThreadSafe> Ring;
+};
+
+global thread_local FCG_ThreadCommandRing GThreadCommandRing;
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::Initialize(FSubsystemCollectionBase & collection)
+{
+	Super::Initialize(collection);
+
+	Registry = collection.InitializeDependency<UCG_TargetRegistrySubsystem>();
+	check(Registry);
+
+	CombatState = collection.InitializeDependency<UCG_CombatStateSubsystem>();
+	check(CombatState);
+
+	RingOwnerId = GNextCommandRingOwner++;
+	NumPending = 0;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::Deinitialize()
+{
+	// NOTE(RyanC): Whatever is left belongs to a world that's going away, nothing to apply it to
+	{
+		FScopeLock lock(&RingsLock);
+		Rings.Empty();
+		RingThreadIds.Empty();
+	}
+
+	Overflow.Empty();
+	NumPending = 0;
+	Drained.Empty();
+	PendingDamage.Empty();
+	Registry = nullptr;
+	CombatState = nullptr;
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::Tick(float deltaTime)
+{
+	Super::Tick(deltaTime);
+	Flush();
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_CombatCommandSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_CombatCommandSubsystem::IsTickable() const
+{
+	return IsInitialized() && NumPending.load(std::memory_order_relaxed) > 0;
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_CombatCommandSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_CombatCommandSubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::PushDamage(FCG_TargetHandle target, int32 damage)
+{
+	FCG_CombatCommand command;
+	command.Target = target;
+	command.Damage = damage;
+
+	Push(command);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::PushStatus(FCG_TargetHandle target, uint8 status)
+{
+	FCG_CombatCommand command;
+	command.Target = target;
+	command.Status = status;
+
+	Push(command);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::PushForce(FCG_TargetHandle target, const FVector & direction, float strength)
+{
+	FCG_CombatCommand command;
+	command.Target = target;
+	command.Force = direction * strength;
+
+	Push(command);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::Push(const FCG_CombatCommand & command)
+{
+	FCG_CombatCommandRingPtr ring;
+
+	FCG_ThreadCommandRing & cached = GThreadCommandRing;
+	if (cached.OwnerId == RingOwnerId)
+	{
+		ring = cached.Ring.Pin();
+	}
+
+	if (!ring.IsValid())
+	{
+		ring = FindThreadRing();
+		cached.OwnerId = RingOwnerId;
+		cached.Ring = ring;
+	}
+
+	if (!ring->Push(command))
+	{
+		Overflow.Enqueue(command);
+		INC_DWORD_STAT(STAT_CombatCommandsOverflowed);
+	}
+
+	NumPending.fetch_add(1, std::memory_order_relaxed);
+	INC_DWORD_STAT(STAT_CombatCommandsPushed);
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_CombatCommandRingPtr UCG_CombatCommandSubsystem::FindThreadRing()
+{
+	// NOTE(RyanC): Only when a thread first pushes or switches worlds (PIE with several clients),
+	// a thread that comes back to a world picks its old ring up again instead of leaking a new one.
+	const uint32 threadId = FPlatformTLS::GetCurrentThreadId();
+
+	FScopeLock lock(&RingsLock);
+
+	const int32 index = RingThreadIds.IndexOfByKey(threadId);
+	if (index != INDEX_NONE)
+	{
+		return Rings[index];
+	}
+
+	RingThreadIds.Emplace(threadId);
+	return Rings.Emplace_GetRef(MakeShared<FCG_CombatCommandRing, ESPMode::ThreadSafe>());
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatCommandSubsystem::Flush()
+{
+	check(IsInGameThread());
+	CG_SCOPE_CYCLE_COUNTER(STAT_CombatCommandDrain);
+
+	Drained.Reset();
+
+	{
+		FScopeLock lock(&RingsLock);
+		for (const FCG_CombatCommandRingPtr & ring : Rings)
+		{
+			ring->Drain([this](const FCG_CombatCommand & command)
+			{
+				Drained.Add(command);
+			});
+		}
+	}
+
+	FCG_CombatCommand overflowed;
+	while (Overflow.Dequeue(overflowed))
+	{
+		Drained.Add(overflowed);
+	}
+
+	NumPending.fetch_sub(Drained.Num(), std::memory_order_relaxed);
+
+	if (Drained.Num() == 0)
+	{
+		return;
+	}
+
+	// NOTE(RyanC): Rings are drained in the order threads first pushed, which changes from run to
+	// run. Sorting on the forces too means the merged sums come out the same however the pushes
+	// were scheduled, damage and statuses merge the same in any order anyway.
+	Drained.Sort([](const FCG_CombatCommand & a, const FCG_CombatCommand & b)
+	{
+		if (a.Target.Slot != b.Target.Slot)
+		{
+			return a.Target.Slot < b.Target.Slot;
+		}
+		if (a.Target.Generation != b.Target.Generation)
+		{
+			return a.Target.Generation < b.Target.Generation;
+		}
+		if (a.Force.X != b.Force.X)
+		{
+			return a.Force.X < b.Force.X;
+		}
+		if (a.Force.Y != b.Force.Y)
+		{
+			return a.Force.Y < b.Force.Y;
+		}
+		return a.Force.Z < b.Force.Z;
+	});
+
+	// Merge runs for the same target into the first command of the run
+	int32 numMerged = 0;
+	for (int32 i = 0; i < Drained.Num(); ++i)
+	{
+		if (numMerged > 0 && Drained[numMerged - 1].Target == Drained[i].Target)
+		{
+			FCG_CombatCommand & merged = Drained[numMerged - 1];
+			merged.Force += Drained[i].Force;
+			merged.Damage += Drained[i].Damage;
+			merged.Status |= Drained[i].Status;
+			continue;
+		}
+
+		Drained[numMerged++] = Drained[i];
+	}
+
+	Drained.SetNum(numMerged, false);
+	CG_SET_DWORD_STAT(STAT_CombatCommandsApplied, numMerged);
+
+	// Statuses and forces go out first, damage last as one batch so deaths come after everything else
+	PendingDamage.Reset();
+	for (const FCG_CombatCommand & merged : Drained)
+	{
+		// Checked for every command, a blueprint event for an earlier one can destroy anything
+		if (!Registry->GetTarget(merged.Target))
+		{
+			continue;
+		}
+
+		if (merged.Status != 0)
+		{
+			Registry->ApplyStatus(merged.Target, merged.Status);
+		}
+
+		if (!merged.Force.IsNearlyZero())
+		{
+			Registry->ApplyForce(merged.Target, merged.Force.GetSafeNormal(), merged.Force.Size());
+		}
+
+		if (merged.Damage != 0)
+		{
+			PendingDamage.Add({ merged.Target, merged.Damage });
+		}
+	}
+
+	CombatState->ApplyDamage(PendingDamage);
+}
@@ -0,0 +1,92 @@
+// ============================================================
+// FILE: CG_CombatCommandSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/Queue.h"
+#include "HAL/CriticalSection.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_CombatStateSubsystem.h"
+#include "CG_RingCore.h"
+#include <atomic>
+#include "CG_CombatCommandSubsystem.generated.h"
+
+// Commands each pushing thread can have in flight before it spills into the overflow queue
+#define COMBAT_COMMAND_RING_CAPACITY 1024
+
+// ============================================================
+// Everything one push (or every push to the same target once merged) does to a target
+struct FCG_CombatCommand
+{
+	FCG_TargetHandle Target;
+	FVector Force = FVector::ZeroVector;
+	int32 Damage = 0;
+	uint8 Status = 0;
+};
+
+// ============================================================
+// One per thread that pushes, that thread is its only producer and the game thread its only consumer
+typedef CGCore::TSpscRing<FCG_CombatCommand, COMBAT_COMMAND_RING_CAPACITY> FCG_CombatCommandRing;
+typedef TSharedPtr<FCG_CombatCommandRing, ESPMode::ThreadSafe> FCG_CombatCommandRingPtr;
+
+// ============================================================
+// Damage, statuses and forces pushed from anywhere (worker threads, async trace and physics
+// callbacks as well as the game thread) into a lock free ring per pushing thread and applied once a
+// frame. Commands for the same target are merged into one, and targets are resolved in slot order
+// so blueprint events fire in the same order whichever thread got there first.
+UCLASS()
+class CELESTIALGROVE_API UCG_CombatCommandSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	virtual void Initialize(FSubsystemCollectionBase & collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// Safe from any thread. Handles are only resolved when the buffer is drained, anything that
+	// unregisters in the meantime is dropped.
+	void PushDamage(FCG_TargetHandle target, int32 damage);
+	void PushStatus(FCG_TargetHandle target, uint8 status);
+	void PushForce(FCG_TargetHandle target, const FVector & direction, float strength);
+
+	// Game thread only, applies everything pushed so far
+	void Flush();
+
+private:
+// ============================================================
+	void Push(const FCG_CombatCommand & command);
+	FCG_CombatCommandRingPtr FindThreadRing();
+
+// ============================================================
+	// Many producers, the game thread is the only consumer. Pushes never lock, RingsLock is only
+	// taken the first time a thread pushes and while the game thread walks the rings to drain them.
+	TArray<FCG_CombatCommandRingPtr> Rings;
+	TArray<uint32> RingThreadIds;
+	FCriticalSection RingsLock;
+
+	// Only used when a thread's ring is full, that's the one push that allocates
+	TQueue<FCG_CombatCommand, EQueueMode::Mpsc> Overflow;
+
+	// Tells a thread's cached ring apart from one it had in a world that has since gone away
+	uint32 RingOwnerId = 0;
+
+	// Only so IsTickable doesn't have to look at every ring
+	std::atomic<int32> NumPending { 0 };
+
+	// Scratch for a drain, game thread only
+	TArray<FCG_CombatCommand> Drained;
+	TArray<FCG_CombatDamage> PendingDamage;
+
+	const UCG_TargetRegistrySubsystem * Registry = nullptr;
+	UCG_CombatStateSubsystem * CombatState = nullptr;
+};
+// ============================================================
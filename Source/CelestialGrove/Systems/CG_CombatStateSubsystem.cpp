@@ -0,0 +1,244 @@
+// ============================================================
+// FILE: CG_CombatStateSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_CombatStateSubsystem.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Combat Damage Batch"), STAT_CombatDamageBatch, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Combat Event Dispatch"), STAT_CombatEventDispatch, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::Initialize(FSubsystemCollectionBase & collection)
+{
+	Super::Initialize(collection);
+
+	Registry = collection.InitializeDependency<UCG_TargetRegistrySubsystem>();
+	check(Registry);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::Deinitialize()
+{
+	TargetHandles.Empty();
+	Health.Empty();
+	MaxHealth.Empty();
+	Status.Empty();
+	Handlers.Empty();
+	CombatantIds.Empty();
+	IdToIndex.Empty();
+	FreeIds.Empty();
+	TargetSlotToId.Empty();
+	PendingEvents.Empty();
+	QueryHits.Empty();
+	Registry = nullptr;
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+int32 UCG_CombatStateSubsystem::RegisterCombatant(FCG_TargetHandle target, const FCG_Stats & stats, FCG_CombatEventDelegate handler)
+{
+	check(IsInGameThread());
+	check(target.IsSet());
+
+	int32 combatantId = FreeIds.Num() > 0 ? FreeIds.Pop(false) : IdToIndex.Emplace(INDEX_NONE);
+
+	int32 index = TargetHandles.Emplace(target);
+	Health.Emplace(stats.Health);
+	MaxHealth.Emplace(stats.Health);
+	Status.Emplace(stats.Status);
+	Handlers.Emplace(MoveTemp(handler));
+	CombatantIds.Emplace(combatantId);
+
+	IdToIndex[combatantId] = index;
+
+	while (TargetSlotToId.Num() <= target.Slot)
+	{
+		TargetSlotToId.Emplace(INDEX_NONE);
+	}
+	TargetSlotToId[target.Slot] = combatantId;
+
+	return combatantId;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::UnregisterCombatant(int32 combatantId)
+{
+	check(IsInGameThread());
+
+	const int32 index = IdToIndex[combatantId];
+	check(Health.IsValidIndex(index));
+
+	const int32 slot = TargetHandles[index].Slot;
+	if (TargetSlotToId[slot] == combatantId)
+	{
+		TargetSlotToId[slot] = INDEX_NONE;
+	}
+
+	// Swap the last combatant into the hole so the arrays stay packed
+	TargetHandles.RemoveAtSwap(index, 1, false);
+	Health.RemoveAtSwap(index, 1, false);
+	MaxHealth.RemoveAtSwap(index, 1, false);
+	Status.RemoveAtSwap(index, 1, false);
+	Handlers.RemoveAtSwap(index, 1, false);
+	CombatantIds.RemoveAtSwap(index, 1, false);
+
+	if (CombatantIds.IsValidIndex(index))
+	{
+		IdToIndex[CombatantIds[index]] = index;
+	}
+
+	IdToIndex[combatantId] = INDEX_NONE;
+	FreeIds.Emplace(combatantId);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::ApplyDamage(int32 combatantId, int32 damage)
+{
+	DamageAt(IdToIndex[combatantId], damage);
+	DispatchEvents();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::ApplyDamage(TArrayView<const FCG_CombatDamage> damage)
+{
+	{
+		CG_SCOPE_CYCLE_COUNTER(STAT_CombatDamageBatch);
+
+		for (const FCG_CombatDamage & hit : damage)
+		{
+			const int32 combatantId = FindCombatant(hit.Target);
+			if (combatantId != INDEX_NONE)
+			{
+				DamageAt(IdToIndex[combatantId], hit.Damage);
+			}
+			else
+			{
+				Registry->ApplyDamage(hit.Target, hit.Damage);
+			}
+		}
+	}
+
+	DispatchEvents();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::SetStatusFlags(FCG_TargetHandle target, uint8 flags)
+{
+	const int32 combatantId = FindCombatant(target);
+	if (combatantId == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 index = IdToIndex[combatantId];
+	ChangeStatusAt(index, Status[index] | flags);
+	DispatchEvents();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::ClearStatusFlags(FCG_TargetHandle target, uint8 flags)
+{
+	const int32 combatantId = FindCombatant(target);
+	if (combatantId == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 index = IdToIndex[combatantId];
+	ChangeStatusAt(index, Status[index] & ~flags);
+	DispatchEvents();
+}
+
+// -----------------------------------------------------------------------------------------
+int32 UCG_CombatStateSubsystem::FindCombatant(FCG_TargetHandle target) const
+{
+	if (!TargetSlotToId.IsValidIndex(target.Slot))
+	{
+		return INDEX_NONE;
+	}
+
+	// NOTE(RyanC): The slot could belong to a newer target by now, only the exact handle counts
+	const int32 combatantId = TargetSlotToId[target.Slot];
+	if (combatantId == INDEX_NONE || !(TargetHandles[IdToIndex[combatantId]] == target))
+	{
+		return INDEX_NONE;
+	}
+
+	return combatantId;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::GetCombatantsInSphere(const FVector & origin, float radius, float maxHealthFraction, TArray<int32> & combatantIds) const
+{
+	QueryHits.Reset();
+	Registry->GetTargetsInSphere(ESpellCollisionType::ALL, origin, radius, nullptr, QueryHits);
+
+	for (const FCG_TargetHit & hit : QueryHits)
+	{
+		const int32 combatantId = FindCombatant(hit.Handle);
+		if (combatantId != INDEX_NONE && GetHealthFractionAt(IdToIndex[combatantId]) <= maxHealthFraction)
+		{
+			combatantIds.Emplace(combatantId);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::DamageAt(int32 index, int32 damage)
+{
+	// NOTE(RyanC): Dying is crossing to zero, already dead combatants don't die again. Hits that
+	// don't take any health away aren't damage, no event for them.
+	const int32 previous = Health[index];
+	if (previous <= 0 || damage <= 0)
+	{
+		return;
+	}
+
+	Health[index] = FMath::Max(previous - damage, 0);
+	PendingEvents.Add({ CombatantIds[index], (Health[index] <= 0) ? ECombatEvent::DIED : ECombatEvent::DAMAGED });
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::ChangeStatusAt(int32 index, uint8 status)
+{
+	if (Status[index] == status)
+	{
+		return;
+	}
+
+	Status[index] = status;
+	PendingEvents.Add({ CombatantIds[index], ECombatEvent::STATUS_CHANGED });
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_CombatStateSubsystem::DispatchEvents()
+{
+	// Handlers can deal more damage, that just lands on the end of the queue being walked
+	if (IsDispatching)
+	{
+		return;
+	}
+
+	CG_SCOPE_CYCLE_COUNTER(STAT_CombatEventDispatch);
+	IsDispatching = true;
+
+	for (int32 i = 0; i < PendingEvents.Num(); ++i)
+	{
+		const FCG_PendingCombatEvent pending = PendingEvents[i];
+
+		// Unregistered by an earlier handler (destroyed on death and so on)
+		const int32 index = IdToIndex.IsValidIndex(pending.CombatantId) ? IdToIndex[pending.CombatantId] : INDEX_NONE;
+		if (index == INDEX_NONE)
+		{
+			continue;
+		}
+
+		Handlers[index].ExecuteIfBound(pending.Event, Health[index], Status[index]);
+	}
+
+	PendingEvents.Reset();
+	IsDispatching = false;
+}
@@ -0,0 +1,142 @@
+// ============================================================
+// FILE: CG_CombatStateSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_CombatStateSubsystem.generated.h"
+
+// ============================================================
+enum class ECombatEvent : uint8
+{
+	DAMAGED = 0,
+	DIED,
+	STATUS_CHANGED
+};
+
+// Health and status are what they are after the change, owners mirror them into their FCG_Stats
+DECLARE_DELEGATE_ThreeParams(FCG_CombatEventDelegate, ECombatEvent, int32, uint8);
+
+// ============================================================
+struct FCG_CombatDamage
+{
+	FCG_TargetHandle Target;
+	int32 Damage;
+};
+
+// ============================================================
+// Health and status for everything that can be hurt (player, enemies, interactables) in packed
+// arrays, owners only hold an id. Damage is applied to the arrays in one go and the owners are
+// told what happened to them afterwards, so a batch never calls out halfway through.
+UCLASS()
+class CELESTIALGROVE_API UCG_CombatStateSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	virtual void Initialize(FSubsystemCollectionBase & collection) override;
+	virtual void Deinitialize() override;
+
+	// Returns a stable id for the combatant, stats are the starting values. The owner has to be
+	// registered as a spell target first.
+	int32 RegisterCombatant(FCG_TargetHandle target, const FCG_Stats & stats, FCG_CombatEventDelegate handler);
+	void UnregisterCombatant(int32 combatantId);
+
+	void ApplyDamage(int32 combatantId, int32 damage);
+
+	// Targets without combat state fall back to their damage delegate
+	void ApplyDamage(TArrayView<const FCG_CombatDamage> damage);
+
+	void SetStatusFlags(FCG_TargetHandle target, uint8 flags);
+	void ClearStatusFlags(FCG_TargetHandle target, uint8 flags);
+
+	// INDEX_NONE if the target has no combat state or has unregistered
+	int32 FindCombatant(FCG_TargetHandle target) const;
+
+	// Every combatant whose bounds touch the sphere and whose health is at or under the fraction,
+	// answered from the target registry's grid and these arrays without touching any actors.
+	void GetCombatantsInSphere(const FVector & origin, float radius, float maxHealthFraction, TArray<int32> & combatantIds) const;
+
+	FORCEINLINE int32 GetHealth(int32 combatantId) const;
+	FORCEINLINE int32 GetMaxHealth(int32 combatantId) const;
+	FORCEINLINE float GetHealthFraction(int32 combatantId) const;
+	FORCEINLINE uint8 GetStatus(int32 combatantId) const;
+	FORCEINLINE int32 GetNumCombatants() const;
+
+private:
+// ============================================================
+	struct FCG_PendingCombatEvent
+	{
+		int32 CombatantId;
+		ECombatEvent Event;
+	};
+
+	void DamageAt(int32 index, int32 damage);
+	void ChangeStatusAt(int32 index, uint8 status);
+	void DispatchEvents();
+	FORCEINLINE float GetHealthFractionAt(int32 index) const;
+
+// ============================================================
+	// Packed, swap removed
+	TArray<FCG_TargetHandle> TargetHandles;
+	TArray<int32> Health;
+	TArray<int32> MaxHealth;
+	TArray<uint8> Status;
+	TArray<FCG_CombatEventDelegate> Handlers;
+	TArray<int32> CombatantIds;
+
+	// Stable id -> packed index
+	TArray<int32> IdToIndex;
+	TArray<int32> FreeIds;
+
+	// Target registry slot -> stable id
+	TArray<int32> TargetSlotToId;
+
+	TArray<FCG_PendingCombatEvent> PendingEvents;
+	bool IsDispatching = false;
+
+	UCG_TargetRegistrySubsystem * Registry = nullptr;
+
+	// Scratch for sphere queries, game thread only
+	mutable TArray<FCG_TargetHit> QueryHits;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_CombatStateSubsystem::GetHealth(int32 combatantId) const
+{
+	return Health[IdToIndex[combatantId]];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_CombatStateSubsystem::GetMaxHealth(int32 combatantId) const
+{
+	return MaxHealth[IdToIndex[combatantId]];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_CombatStateSubsystem::GetHealthFraction(int32 combatantId) const
+{
+	return GetHealthFractionAt(IdToIndex[combatantId]);
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_CombatStateSubsystem::GetHealthFractionAt(int32 index) const
+{
+	return (MaxHealth[index] > 0) ? (float)Health[index] / (float)MaxHealth[index] : 0.0f;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE uint8 UCG_CombatStateSubsystem::GetStatus(int32 combatantId) const
+{
+	return Status[IdToIndex[combatantId]];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_CombatStateSubsystem::GetNumCombatants() const
+{
+	return Health.Num();
+}
+// ============================================================
@@ -0,0 +1,231 @@
+// ============================================================
+// FILE: CG_EffectPoolSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_EffectPoolSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "NiagaraComponent.h"
+#include "NiagaraSystem.h"
+#include "Components/DecalComponent.h"
+#include "Materials/MaterialInterface.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Hits"), STAT_EffectPoolHits, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Misses"), STAT_EffectPoolMisses, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Pool Overflow"), STAT_EffectPoolOverflow, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Decal Pool Misses"), STAT_DecalPoolMisses, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Decal Pool Recycled"), STAT_DecalPoolRecycled, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+UCG_EffectPoolSubsystem::UCG_EffectPoolSubsystem()
+{
+	DefaultPoolSize = 4;
+	DecalsPerMaterial = 32;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_EffectPoolSubsystem::OnWorldBeginPlay(UWorld & world)
+{
+	Super::OnWorldBeginPlay(world);
+
+	// NOTE(RyanC): Loading here hitches the level start instead of the first cast, which is the point.
+	for (const FCG_EffectPoolSize & poolSize : PoolSizes)
+	{
+		UNiagaraSystem * system = poolSize.System.LoadSynchronous();
+		if (!system)
+		{
+			UE_LOG(LogCelestialGrove, Warning, TEXT("Effect pool system %s failed to load, it won't be pre-warmed."), *poolSize.System.ToString());
+			continue;
+		}
+
+		FCG_NiagaraPool & pool = FindOrAddPool(system);
+		while (pool.NumPooled < pool.MaxSize)
+		{
+			pool.Free.Emplace(CreateEffectComponent(system));
+			++pool.NumPooled;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_EffectPoolSubsystem::Deinitialize()
+{
+	for (TPair<TObjectPtr<UNiagaraSystem>, FCG_NiagaraPool> & pair : EffectPools)
+	{
+		for (UNiagaraComponent * component : pair.Value.Free)
+		{
+			if (component)
+			{
+				component->DestroyComponent();
+			}
+		}
+	}
+
+	for (TPair<TObjectPtr<UMaterialInterface>, FCG_DecalPool> & pair : DecalPools)
+	{
+		for (UDecalComponent * decal : pair.Value.Decals)
+		{
+			if (decal)
+			{
+				decal->DestroyComponent();
+			}
+		}
+	}
+
+	EffectPools.Empty();
+	DecalPools.Empty();
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+UNiagaraComponent * UCG_EffectPoolSubsystem::AcquireEffect(UNiagaraSystem * system, const FVector & location, const FRotator & rotation)
+{
+	check(IsInGameThread());
+	check(system);
+
+	FCG_NiagaraPool & pool = FindOrAddPool(system);
+
+	UNiagaraComponent * component = nullptr;
+	while (!component && pool.Free.Num() > 0)
+	{
+		// Something outside the pool could have destroyed it (level streaming, editor), just drop those
+		component = pool.Free.Pop(false);
+		if (!IsValid(component))
+		{
+			component = nullptr;
+			--pool.NumPooled;
+		}
+	}
+
+	if (component)
+	{
+		INC_DWORD_STAT(STAT_EffectPoolHits);
+	}
+	else if (pool.NumPooled < pool.MaxSize)
+	{
+		INC_DWORD_STAT(STAT_EffectPoolMisses);
+		component = CreateEffectComponent(system);
+		++pool.NumPooled;
+	}
+	else
+	{
+		// NOTE(RyanC): Still hand one out, it just gets destroyed on release instead of kept.
+		INC_DWORD_STAT(STAT_EffectPoolOverflow);
+		component = CreateEffectComponent(system);
+	}
+
+	component->SetWorldLocationAndRotation(location, rotation);
+	component->Activate(true);
+	return component;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_EffectPoolSubsystem::ReleaseEffect(UNiagaraComponent * component)
+{
+	check(IsInGameThread());
+
+	if (!IsValid(component))
+	{
+		return;
+	}
+
+	// Let the particles die out on their own, it goes back to the pool when the system finishes
+	component->OnSystemFinished.AddUniqueDynamic(this, &UCG_EffectPoolSubsystem::OnPooledEffectFinished);
+
+	if (component->IsActive())
+	{
+		component->Deactivate();
+	}
+	else
+	{
+		// One shot systems can finish before the spell does, nothing left to wait on
+		OnPooledEffectFinished(component);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_EffectPoolSubsystem::OnPooledEffectFinished(UNiagaraComponent * component)
+{
+	component->OnSystemFinished.RemoveDynamic(this, &UCG_EffectPoolSubsystem::OnPooledEffectFinished);
+
+	FCG_NiagaraPool * pool = EffectPools.Find(component->GetAsset());
+	if (!pool || pool->Free.Num() >= pool->NumPooled)
+	{
+		// Overflow, the pool already has as many as it owns
+		component->DestroyComponent();
+		return;
+	}
+
+	pool->Free.Emplace(component);
+}
+
+// -----------------------------------------------------------------------------------------
+UDecalComponent * UCG_EffectPoolSubsystem::AcquireDecal(UMaterialInterface * material, const FVector & location, const FRotator & rotation, const FVector & size)
+{
+	check(IsInGameThread());
+	check(material);
+
+	FCG_DecalPool & pool = DecalPools.FindOrAdd(material);
+
+	UDecalComponent * decal = nullptr;
+	if (pool.Decals.Num() < DecalsPerMaterial)
+	{
+		INC_DWORD_STAT(STAT_DecalPoolMisses);
+
+		decal = NewObject<UDecalComponent>(GetWorld());
+		decal->SetDecalMaterial(material);
+		decal->RegisterComponentWithWorld(GetWorld());
+		pool.Decals.Emplace(decal);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_DecalPoolRecycled);
+
+		decal = pool.Decals[pool.Next];
+		pool.Next = (pool.Next + 1) % pool.Decals.Num();
+	}
+
+	decal->DecalSize = size;
+	decal->SetWorldLocationAndRotation(location, rotation);
+	decal->MarkRenderStateDirty();
+	return decal;
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_NiagaraPool & UCG_EffectPoolSubsystem::FindOrAddPool(UNiagaraSystem * system)
+{
+	FCG_NiagaraPool * pool = EffectPools.Find(system);
+	if (pool)
+	{
+		return *pool;
+	}
+
+	FCG_NiagaraPool & newPool = EffectPools.Add(system);
+	newPool.MaxSize = DefaultPoolSize;
+
+	for (const FCG_EffectPoolSize & poolSize : PoolSizes)
+	{
+		if (poolSize.System.ToSoftObjectPath() == FSoftObjectPath(system))
+		{
+			newPool.MaxSize = poolSize.Size;
+			break;
+		}
+	}
+
+	return newPool;
+}
+
+// -----------------------------------------------------------------------------------------
+UNiagaraComponent * UCG_EffectPoolSubsystem::CreateEffectComponent(UNiagaraSystem * system)
+{
+	UWorld * world = GetWorld();
+
+	UNiagaraComponent * component = NewObject<UNiagaraComponent>(world);
+	component->SetAutoActivate(false);
+	component->SetAutoDestroy(false);
+	component->SetAsset(system);
+	component->RegisterComponentWithWorld(world);
+
+	return component;
+}
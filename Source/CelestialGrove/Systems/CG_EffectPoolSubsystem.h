@@ -0,0 +1,110 @@
+// ============================================================
+// FILE: CG_EffectPoolSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_EffectPoolSubsystem.generated.h"
+
+class UNiagaraSystem;
+class UNiagaraComponent;
+class UDecalComponent;
+class UMaterialInterface;
+
+// ============================================================
+USTRUCT()
+struct FCG_EffectPoolSize
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Config)
+	TSoftObjectPtr<UNiagaraSystem> System;
+
+	UPROPERTY(Config)
+	int32 Size = 4;
+};
+
+// ============================================================
+USTRUCT()
+struct FCG_NiagaraPool
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UNiagaraComponent>> Free;
+
+	// Components owned by the pool, whether they're free or not
+	int32 NumPooled = 0;
+	int32 MaxSize = 0;
+};
+
+// ============================================================
+USTRUCT()
+struct FCG_DecalPool
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UDecalComponent>> Decals;
+
+	// Ring buffer, once it's full the oldest decal gets moved
+	int32 Next = 0;
+};
+
+// ============================================================
+// Keeps pre-warmed Niagara components and decals around so spell effects don't create and destroy
+// a component every cast. Effects are pooled per system, decals per material.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_EffectPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_EffectPoolSubsystem();
+
+	virtual void OnWorldBeginPlay(UWorld & world) override;
+	virtual void Deinitialize() override;
+
+	// Hands out a component from the system's pool, already activated at the given transform.
+	UNiagaraComponent * AcquireEffect(UNiagaraSystem * system, const FVector & location, const FRotator & rotation);
+
+	// The component is deactivated and goes back to the pool once its particles have finished.
+	void ReleaseEffect(UNiagaraComponent * component);
+
+	// Decals are never released, the pool just recycles the oldest one once it runs out.
+	UDecalComponent * AcquireDecal(UMaterialInterface * material, const FVector & location, const FRotator & rotation, const FVector & size);
+
+protected:
+// ============================================================
+	// Pool size for systems that aren't listed in PoolSizes
+	UPROPERTY(Config)
+	int32 DefaultPoolSize;
+
+	UPROPERTY(Config)
+	TArray<FCG_EffectPoolSize> PoolSizes;
+
+	UPROPERTY(Config)
+	int32 DecalsPerMaterial;
+
+private:
+// ============================================================
+	FCG_NiagaraPool & FindOrAddPool(UNiagaraSystem * system);
+	UNiagaraComponent * CreateEffectComponent(UNiagaraSystem * system);
+
+	UFUNCTION()
+	void OnPooledEffectFinished(UNiagaraComponent * component);
+
+// ============================================================
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UNiagaraSystem>, FCG_NiagaraPool> EffectPools;
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UMaterialInterface>, FCG_DecalPool> DecalPools;
+};
@@ -0,0 +1,73 @@
+// ============================================================
+// FILE: CG_FrameTimings.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_FrameTimings.h"
+#include "CG_GlobalDefines.h"
+#include "RenderCore.h"
+
+// -----------------------------------------------------------------------------------------
+// Nearest rank, samples has to be sorted
+internal float GetPercentile(const TArray<float> & samples, float percentile)
+{
+	const int32 rank = FMath::CeilToInt(percentile * samples.Num()) - 1;
+	return samples[FMath::Clamp(rank, 0, samples.Num() - 1)];
+}
+
+// -----------------------------------------------------------------------------------------
+internal void WriteTimings(FCG_BenchmarkJsonWriter & writer, const TCHAR * name, TArray<float> samples)
+{
+	writer.WriteObjectStart(name);
+
+	if (samples.Num() > 0)
+	{
+		samples.Sort();
+
+		double sum = 0.0;
+		for (float sample : samples)
+		{
+			sum += sample;
+		}
+
+		writer.WriteValue(TEXT("mean"), sum / samples.Num());
+		writer.WriteValue(TEXT("p50"), GetPercentile(samples, 0.50f));
+		writer.WriteValue(TEXT("p90"), GetPercentile(samples, 0.90f));
+		writer.WriteValue(TEXT("p95"), GetPercentile(samples, 0.95f));
+		writer.WriteValue(TEXT("p99"), GetPercentile(samples, 0.99f));
+		writer.WriteValue(TEXT("max"), samples.Last());
+	}
+
+	writer.WriteObjectEnd();
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_FrameTimings::Sample(bool isMeasuring)
+{
+	// NOTE(RyanC): Wall time from one call to the next. With -nullrhi there's nothing else for the
+	// frame to wait on so this is the game thread plus whatever it blocks on.
+	const uint64 nowCycles = FPlatformTime::Cycles64();
+	const uint64 lastCycles = LastFrameCycles;
+	LastFrameCycles = nowCycles;
+
+	if (isMeasuring && lastCycles > 0)
+	{
+		FrameTimes.Add((float)FPlatformTime::ToMilliseconds64(nowCycles - lastCycles));
+		GameThreadTimes.Add((float)FPlatformTime::ToMilliseconds(GGameThreadTime));
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_FrameTimings::Write(FCG_BenchmarkJsonWriter & writer) const
+{
+	WriteTimings(writer, TEXT("frameTimeMs"), FrameTimes);
+	WriteTimings(writer, TEXT("gameThreadMs"), GameThreadTimes);
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_FrameTimings::Empty()
+{
+	FrameTimes.Empty();
+	GameThreadTimes.Empty();
+	LastFrameCycles = 0;
+}
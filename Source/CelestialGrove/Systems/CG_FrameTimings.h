@@ -0,0 +1,45 @@
+// ============================================================
+// FILE: CG_FrameTimings.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+typedef TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>> FCG_BenchmarkJsonWriter;
+
+// ============================================================
+// Frame and game thread times for anything that writes benchmark results, so the benchmark
+// scenario and session playback report them the same way.
+struct CELESTIALGROVE_API FCG_FrameTimings
+{
+	// Call once per frame. The first call only starts the clock, frames are only kept while measuring.
+	void Sample(bool isMeasuring);
+
+	// Writes "frameTimeMs" and "gameThreadMs" objects with the mean, percentiles and max
+	void Write(FCG_BenchmarkJsonWriter & writer) const;
+
+	void Empty();
+
+	FORCEINLINE int32 GetNumFrames() const;
+
+private:
+// ============================================================
+	// Milliseconds, one per measured frame
+	TArray<float> FrameTimes;
+	TArray<float> GameThreadTimes;
+
+	uint64 LastFrameCycles = 0;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 FCG_FrameTimings::GetNumFrames() const
+{
+	return FrameTimes.Num();
+}
+// ============================================================
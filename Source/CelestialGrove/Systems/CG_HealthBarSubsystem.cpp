@@ -0,0 +1,80 @@
+// ============================================================
+// FILE: CG_HealthBarSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_HealthBarSubsystem.h"
+#include "GameFramework/Actor.h"
+
+// -----------------------------------------------------------------------------------------
+void UCG_HealthBarSubsystem::Deinitialize()
+{
+	Owners.Empty();
+	Offsets.Empty();
+	Fractions.Empty();
+	OwnerToIndex.Empty();
+	++Revision;
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_HealthBarSubsystem::ShowBar(const AActor * owner, const FVector & offset, float fraction)
+{
+	check(IsInGameThread());
+	check(owner);
+
+	const int32 * existing = OwnerToIndex.Find(owner);
+	if (existing)
+	{
+		Offsets[*existing] = offset;
+		SetBarHealth(owner, fraction);
+		return;
+	}
+
+	int32 index = Owners.Emplace(owner);
+	Offsets.Emplace(offset);
+	Fractions.Emplace(FMath::Clamp(fraction, 0.0f, 1.0f));
+	OwnerToIndex.Add(owner, index);
+	++Revision;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_HealthBarSubsystem::HideBar(const AActor * owner)
+{
+	check(IsInGameThread());
+
+	int32 index;
+	if (!OwnerToIndex.RemoveAndCopyValue(owner, index))
+	{
+		return;
+	}
+
+	const int32 last = Owners.Num() - 1;
+	if (index != last)
+	{
+		OwnerToIndex[Owners[last].GetEvenIfUnreachable()] = index;
+	}
+
+	Owners.RemoveAtSwap(index, 1, false);
+	Offsets.RemoveAtSwap(index, 1, false);
+	Fractions.RemoveAtSwap(index, 1, false);
+	++Revision;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_HealthBarSubsystem::SetBarHealth(const AActor * owner, float fraction)
+{
+	const int32 * index = OwnerToIndex.Find(owner);
+	if (!index)
+	{
+		return;
+	}
+
+	fraction = FMath::Clamp(fraction, 0.0f, 1.0f);
+	if (Fractions[*index] != fraction)
+	{
+		Fractions[*index] = fraction;
+		++Revision;
+	}
+}
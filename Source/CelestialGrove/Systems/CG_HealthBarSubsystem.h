@@ -0,0 +1,78 @@
+// ============================================================
+// FILE: CG_HealthBarSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GameFramework/Actor.h"
+#include "CG_HealthBarSubsystem.generated.h"
+
+// ============================================================
+// Every health bar that should be on screen, packed so the HUD's health bar layer can walk them
+// in one go. Owners only push changes in, nothing here ticks.
+UCLASS()
+class CELESTIALGROVE_API UCG_HealthBarSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	virtual void Deinitialize() override;
+
+	// offset is from the owner's location to where the bar sits
+	void ShowBar(const AActor * owner, const FVector & offset, float fraction);
+	void HideBar(const AActor * owner);
+	void SetBarHealth(const AActor * owner, float fraction);
+
+	FORCEINLINE int32 GetNumBars() const;
+	FORCEINLINE float GetFraction(int32 index) const;
+	FORCEINLINE const AActor * GetOwner(int32 index) const;
+	FORCEINLINE FVector GetWorldPosition(int32 index) const;
+
+	// Bumped whenever a bar is added, removed or changes value. Anything caching the bars only
+	// has to compare this to know if it's out of date.
+	FORCEINLINE uint32 GetRevision() const;
+
+private:
+// ============================================================
+	// Packed, swap removed
+	TArray<TWeakObjectPtr<const AActor>> Owners;
+	TArray<FVector> Offsets;
+	TArray<float> Fractions;
+
+	TMap<const AActor *, int32> OwnerToIndex;
+	uint32 Revision = 0;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_HealthBarSubsystem::GetNumBars() const
+{
+	return Owners.Num();
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_HealthBarSubsystem::GetFraction(int32 index) const
+{
+	return Fractions[index];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE const AActor * UCG_HealthBarSubsystem::GetOwner(int32 index) const
+{
+	return Owners[index].Get();
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE FVector UCG_HealthBarSubsystem::GetWorldPosition(int32 index) const
+{
+	const AActor * owner = Owners[index].Get();
+	return owner ? owner->GetActorLocation() + Offsets[index] : FVector::ZeroVector;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE uint32 UCG_HealthBarSubsystem::GetRevision() const
+{
+	return Revision;
+}
+// ============================================================
@@ -0,0 +1,161 @@
+// ============================================================
+// FILE: CG_PhysicsSleepSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_PhysicsSleepSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "Components/PrimitiveComponent.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Physics Sleep Update"), STAT_PhysicsSleepUpdate, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Awake Props"), STAT_NumAwakeBodies, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Props Woken"), STAT_BodiesWoken, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Props Put To Sleep"), STAT_BodiesSlept, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+UCG_PhysicsSleepSubsystem::UCG_PhysicsSleepSubsystem()
+{
+	SettleSpeed = 5.0f;
+	SettleAngularSpeed = 5.0f;
+	SettleTime = 0.5f;
+	MinAwakeTime = 0.25f;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_PhysicsSleepSubsystem::Deinitialize()
+{
+	AwakeBodies.Empty();
+	BodyToIndex.Empty();
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_PhysicsSleepSubsystem::Tick(float deltaTime)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_PhysicsSleepUpdate);
+	Super::Tick(deltaTime);
+
+	const float now = GetWorld()->GetTimeSeconds();
+	const float settleSpeedSq = SettleSpeed * SettleSpeed;
+	const float settleAngularSpeedSq = SettleAngularSpeed * SettleAngularSpeed;
+
+	for (int32 i = AwakeBodies.Num() - 1; i >= 0; --i)
+	{
+		FCG_AwakeBody & awake = AwakeBodies[i];
+		UPrimitiveComponent * body = awake.Body.Get();
+		if (!body || !body->IsSimulatingPhysics())
+		{
+			// Gone, or something else turned simulation off under us (inspection, blueprints)
+			RemoveAt(i);
+			continue;
+		}
+
+		if (now - awake.WakeTime < MinAwakeTime)
+		{
+			continue;
+		}
+
+		// NOTE(RyanC): Chaos putting the body to sleep is the clearest signal, the speed check
+		// catches bodies that rock on the ground without ever getting there.
+		bool settled = !body->RigidBodyIsAwake();
+		if (!settled)
+		{
+			const bool calm = body->GetPhysicsLinearVelocity().SizeSquared() < settleSpeedSq &&
+				body->GetPhysicsAngularVelocityInDegrees().SizeSquared() < settleAngularSpeedSq;
+
+			awake.CalmTime = calm ? awake.CalmTime + deltaTime : 0.0f;
+			settled = (awake.CalmTime >= SettleTime);
+		}
+
+		if (settled)
+		{
+			SleepBody(i);
+		}
+	}
+
+	CG_SET_DWORD_STAT(STAT_NumAwakeBodies, AwakeBodies.Num());
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_PhysicsSleepSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_PhysicsSleepSubsystem::IsTickable() const
+{
+	return IsInitialized() && AwakeBodies.Num() > 0;
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_PhysicsSleepSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_PhysicsSleepSubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_PhysicsSleepSubsystem::WakeBody(UPrimitiveComponent * body)
+{
+	check(IsInGameThread());
+	check(body);
+
+	const float now = GetWorld()->GetTimeSeconds();
+
+	const int32 * existing = BodyToIndex.Find(body);
+	if (existing)
+	{
+		AwakeBodies[*existing].WakeTime = now;
+		AwakeBodies[*existing].CalmTime = 0.0f;
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_BodiesWoken);
+
+	FCG_AwakeBody & awake = AwakeBodies.AddDefaulted_GetRef();
+	awake.Body = body;
+	awake.WakeTime = now;
+	awake.CalmTime = 0.0f;
+	BodyToIndex.Add(body, AwakeBodies.Num() - 1);
+
+	body->SetSimulatePhysics(true);
+	body->WakeAllRigidBodies();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_PhysicsSleepSubsystem::ForgetBody(UPrimitiveComponent * body)
+{
+	const int32 * index = BodyToIndex.Find(body);
+	if (index)
+	{
+		RemoveAt(*index);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_PhysicsSleepSubsystem::SleepBody(int32 index)
+{
+	INC_DWORD_STAT(STAT_BodiesSlept);
+
+	UPrimitiveComponent * body = AwakeBodies[index].Body.Get();
+	RemoveAt(index);
+
+	// Stays where it came to rest, just stops being a live rigid body
+	body->SetSimulatePhysics(false);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_PhysicsSleepSubsystem::RemoveAt(int32 index)
+{
+	BodyToIndex.Remove(AwakeBodies[index].Body.GetEvenIfUnreachable());
+
+	const int32 last = AwakeBodies.Num() - 1;
+	if (index != last)
+	{
+		BodyToIndex[AwakeBodies[last].Body.GetEvenIfUnreachable()] = index;
+	}
+
+	AwakeBodies.RemoveAtSwap(index, 1, false);
+}
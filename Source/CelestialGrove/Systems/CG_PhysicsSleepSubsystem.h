@@ -0,0 +1,87 @@
+// ============================================================
+// FILE: CG_PhysicsSleepSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_PhysicsSleepSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+// ============================================================
+struct FCG_AwakeBody
+{
+	TWeakObjectPtr<UPrimitiveComponent> Body;
+	float WakeTime;
+
+	// How long the body has been under the settle speeds
+	float CalmTime;
+};
+
+// ============================================================
+// Props sit in the world as non simulating bodies and only simulate while something is moving
+// them. Woken bodies are handed to this, it turns their simulation back off once they come to
+// rest so the number of live rigid bodies follows what's actually moving.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_PhysicsSleepSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_PhysicsSleepSubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// Turns simulation on, waking a body that's already awake just restarts its settle timer
+	void WakeBody(UPrimitiveComponent * body);
+
+	// Stops managing the body without touching its simulation, for bodies something else has taken over
+	void ForgetBody(UPrimitiveComponent * body);
+
+	FORCEINLINE int32 GetNumAwakeBodies() const;
+
+protected:
+// ============================================================
+	// cm/s
+	UPROPERTY(Config)
+	float SettleSpeed;
+
+	// deg/s
+	UPROPERTY(Config)
+	float SettleAngularSpeed;
+
+	// How long a body has to stay under both speeds before it's put back to sleep
+	UPROPERTY(Config)
+	float SettleTime;
+
+	// A body can't settle before this, gives whatever woke it a chance to get it moving
+	UPROPERTY(Config)
+	float MinAwakeTime;
+
+private:
+// ============================================================
+	void SleepBody(int32 index);
+	void RemoveAt(int32 index);
+
+// ============================================================
+	// Packed, swap removed
+	TArray<FCG_AwakeBody> AwakeBodies;
+	TMap<const UPrimitiveComponent *, int32> BodyToIndex;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_PhysicsSleepSubsystem::GetNumAwakeBodies() const
+{
+	return AwakeBodies.Num();
+}
+// ============================================================
@@ -0,0 +1,213 @@
+// ============================================================
+// FILE: CG_ProjectileSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_ProjectileSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_SpellBase.h"
+#include "CG_PlayerCharacter.h"
+#include "CG_SpellTargeting.h"
+#include "Engine/World.h"
+#include "NiagaraComponent.h"
+#include "NiagaraSystem.h"
+#include "NiagaraDataInterfaceArrayFunctionLibrary.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Projectile Update"), STAT_ProjectileUpdate, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectiles"), STAT_NumProjectiles, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+internal FCollisionObjectQueryParams GetProjectileObjectParams(ESpellCollisionType type)
+{
+	FCollisionObjectQueryParams objParams = GetSpellObjectQueryParams(type);
+
+	// Walls stop projectiles whatever they're allowed to hit
+	objParams.AddObjectTypesToQuery(ECollisionChannel::ECC_WorldStatic);
+	return objParams;
+}
+
+// -----------------------------------------------------------------------------------------
+UCG_ProjectileSubsystem::UCG_ProjectileSubsystem()
+{
+	ProjectileRadius = 10.0f;
+	VisualPositionsParameter = TEXT("ProjectilePositions");
+	VisualVelocitiesParameter = TEXT("ProjectileVelocities");
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_ProjectileSubsystem::Initialize(FSubsystemCollectionBase & collection)
+{
+	Super::Initialize(collection);
+
+	// NOTE(RyanC): Same place the scene queries flush, sweeps issued here make it into this frame's
+	// async batch and are back by the time it comes round again.
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCG_ProjectileSubsystem::UpdateProjectiles);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_ProjectileSubsystem::OnWorldBeginPlay(UWorld & world)
+{
+	Super::OnWorldBeginPlay(world);
+
+	if (VisualSystem.IsNull())
+	{
+		return;
+	}
+
+	UNiagaraSystem * system = VisualSystem.LoadSynchronous();
+	if (!system)
+	{
+		UE_LOG(LogCelestialGrove, Warning, TEXT("Projectile visual system %s failed to load, projectiles won't be drawn."), *VisualSystem.ToString());
+		return;
+	}
+
+	VisualComponent = NewObject<UNiagaraComponent>(&world);
+	VisualComponent->SetAutoDestroy(false);
+	VisualComponent->SetAsset(system);
+	VisualComponent->RegisterComponentWithWorld(&world);
+	VisualComponent->Activate(true);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_ProjectileSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	if (VisualComponent)
+	{
+		VisualComponent->DestroyComponent();
+		VisualComponent = nullptr;
+	}
+
+	Projectiles.Empty();
+	VisualPositions.Empty();
+	VisualVelocities.Empty();
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_ProjectileSubsystem::UpdateProjectiles(UWorld * world, ELevelTick tickType, float deltaTime)
+{
+	// One more update after the last projectile is gone to clear the visuals
+	if (world != GetWorld() || world->IsPaused() || (Projectiles.Num() == 0 && VisualPositions.Num() == 0))
+	{
+		return;
+	}
+
+	CG_SCOPE_CYCLE_COUNTER(STAT_ProjectileUpdate);
+
+	const FCollisionObjectQueryParams objParams[] =
+	{
+		GetProjectileObjectParams(ESpellCollisionType::ALL),
+		GetProjectileObjectParams(ESpellCollisionType::INANIMATE_ONLY),
+		GetProjectileObjectParams(ESpellCollisionType::ANIMATE_ONLY)
+	};
+
+	FCollisionShape shape = FCollisionShape::MakeSphere(ProjectileRadius);
+	FCollisionQueryParams params(SCENE_QUERY_STAT(CG_ProjectileSweep), false);
+
+	// NOTE(RyanC): Resolving a projectile calls back into the spell which can fire another one, so
+	// nothing is resolved until every projectile has been moved.
+	TArray<FCG_ProjectileResult, TInlineAllocator<16>> finished;
+
+	for (int32 i = Projectiles.Num() - 1; i >= 0; --i)
+	{
+		FCG_Projectile & projectile = Projectiles[i];
+		if (!projectile.Spell.IsValid())
+		{
+			Projectiles.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		// Last frame's sweep, a handle that didn't come back just gets swept again from where it was
+		FTraceDatum datum;
+		if (projectile.SweepHandle.IsValid() && world->QueryTraceData(projectile.SweepHandle, datum))
+		{
+			const bool wasHit = datum.OutHits.Num() > 0 && datum.OutHits[0].bBlockingHit;
+			if (wasHit || projectile.Lifetime <= 0.0f)
+			{
+				finished.Add({ projectile, wasHit ? datum.OutHits[0] : FHitResult(), wasHit });
+				Projectiles.RemoveAtSwap(i, 1, false);
+				continue;
+			}
+
+			projectile.Position = projectile.SweepEnd;
+		}
+
+		projectile.Lifetime -= deltaTime;
+		projectile.SweepEnd = projectile.Position + (projectile.Velocity * deltaTime);
+
+		params.ClearIgnoredActors();
+		if (projectile.Caster.IsValid())
+		{
+			params.AddIgnoredActor(projectile.Caster.Get());
+		}
+
+		projectile.SweepHandle = world->AsyncSweepByObjectType(EAsyncTraceType::Single, projectile.Position, projectile.SweepEnd, FQuat::Identity, objParams[(int32)projectile.CollisionType], shape, params);
+	}
+
+	for (const FCG_ProjectileResult & result : finished)
+	{
+		ResolveProjectile(result);
+	}
+
+	CG_SET_DWORD_STAT(STAT_NumProjectiles, Projectiles.Num());
+	UpdateVisuals();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_ProjectileSubsystem::SpawnProjectile(const FVector & origin, const FVector & velocity, float lifetime, UCG_SpellBase * spell, const AActor * caster)
+{
+	check(IsInGameThread());
+	check(spell);
+
+	FCG_Projectile & projectile = Projectiles.AddDefaulted_GetRef();
+	projectile.Position = origin;
+	projectile.Velocity = velocity;
+	projectile.Lifetime = lifetime;
+	projectile.CollisionType = spell->GetCollisionType();
+	projectile.Spell = spell;
+	projectile.Caster = caster;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_ProjectileSubsystem::ResolveProjectile(const FCG_ProjectileResult & result)
+{
+	UCG_SpellBase * spell = result.Projectile.Spell.Get();
+	const AActor * caster = result.Projectile.Caster.Get();
+	if (!spell || spell->GetSpellStep() != ESpellComponentCategory::TARGETING)
+	{
+		return;
+	}
+
+	FCG_TargetHit hit;
+	if (result.WasHit && MakeSpellTarget(result.Hit.GetActor(), result.Projectile.CollisionType, result.Hit.ImpactPoint, hit))
+	{
+		// Pushed along the flight path rather than away from the impact point
+		spell->AddTarget(hit.Handle, result.Projectile.Velocity.GetSafeNormal());
+	}
+
+	spell->OnFinishTargeting(caster);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_ProjectileSubsystem::UpdateVisuals()
+{
+	if (!VisualComponent)
+	{
+		return;
+	}
+
+	VisualPositions.Reset(Projectiles.Num());
+	VisualVelocities.Reset(Projectiles.Num());
+	for (const FCG_Projectile & projectile : Projectiles)
+	{
+		VisualPositions.Emplace(projectile.Position);
+		VisualVelocities.Emplace(projectile.Velocity);
+	}
+
+	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(VisualComponent, VisualPositionsParameter, VisualPositions);
+	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(VisualComponent, VisualVelocitiesParameter, VisualVelocities);
+}
@@ -0,0 +1,106 @@
+// ============================================================
+// FILE: CG_ProjectileSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "CG_SpellTypes.h"
+#include "CG_ProjectileSubsystem.generated.h"
+
+class AActor;
+class UCG_SpellBase;
+class UNiagaraSystem;
+class UNiagaraComponent;
+
+// ============================================================
+struct FCG_Projectile
+{
+	// Where the projectile is known to have got to, the sweep in flight goes on from here to SweepEnd
+	FVector Position;
+	FVector SweepEnd;
+	FVector Velocity;
+	float Lifetime;
+	ESpellCollisionType CollisionType;
+	FTraceHandle SweepHandle;
+
+	TWeakObjectPtr<UCG_SpellBase> Spell;
+	TWeakObjectPtr<const AActor> Caster;
+};
+
+// ============================================================
+// Every spell projectile in the world as a plain struct instead of an actor each. Once the actors
+// have ticked, every frame collects the async sweeps issued the frame before and issues the next
+// ones, so the whole batch runs on the async trace workers and a hit lands a frame after the sweep
+// that found it. They're drawn by a single Niagara system fed the positions through array data
+// interfaces.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_ProjectileSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_ProjectileSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase & collection) override;
+	virtual void OnWorldBeginPlay(UWorld & world) override;
+	virtual void Deinitialize() override;
+
+	// The spell finishes targeting when the projectile hits something or runs out of lifetime.
+	void SpawnProjectile(const FVector & origin, const FVector & velocity, float lifetime, UCG_SpellBase * spell, const AActor * caster);
+
+	FORCEINLINE int32 GetNumProjectiles() const;
+
+protected:
+// ============================================================
+	UPROPERTY(Config)
+	float ProjectileRadius;
+
+	UPROPERTY(Config)
+	TSoftObjectPtr<UNiagaraSystem> VisualSystem;
+
+	// Names of the Niagara array user parameters the positions and velocities are written to
+	UPROPERTY(Config)
+	FName VisualPositionsParameter;
+
+	UPROPERTY(Config)
+	FName VisualVelocitiesParameter;
+
+private:
+// ============================================================
+	struct FCG_ProjectileResult
+	{
+		FCG_Projectile Projectile;
+		FHitResult Hit;
+		bool WasHit;
+	};
+
+	void UpdateProjectiles(UWorld * world, ELevelTick tickType, float deltaTime);
+	void ResolveProjectile(const FCG_ProjectileResult & result);
+	void UpdateVisuals();
+
+// ============================================================
+	TArray<FCG_Projectile> Projectiles;
+
+	// Scratch for the visuals so they don't reallocate every frame
+	TArray<FVector> VisualPositions;
+	TArray<FVector> VisualVelocities;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UNiagaraComponent> VisualComponent;
+
+	FDelegateHandle PostActorTickHandle;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_ProjectileSubsystem::GetNumProjectiles() const
+{
+	return Projectiles.Num();
+}
+// ============================================================
@@ -0,0 +1,205 @@
+// ============================================================
+// FILE: CG_RagdollSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_RagdollSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_EnemyCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ragdoll Update"), STAT_RagdollUpdate, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Ragdolls"), STAT_NumRagdolls, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ragdolls Evicted"), STAT_RagdollsEvicted, STATGROUP_CelestialGrove);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Ragdolls Refused"), STAT_RagdollsRefused, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+UCG_RagdollSubsystem::UCG_RagdollSubsystem()
+{
+	MaxActiveRagdolls = 12;
+	MinRagdollTime = 0.5f;
+	MaxRagdollTime = 8.0f;
+	SettleTime = 0.25f;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_RagdollSubsystem::Deinitialize()
+{
+	Ragdolls.Empty();
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_RagdollSubsystem::Tick(float deltaTime)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_RagdollUpdate);
+	Super::Tick(deltaTime);
+
+	const float now = GetWorld()->GetTimeSeconds();
+
+	// NOTE(RyanC): Settling calls into blueprints which can knock something else over, so walk
+	// backwards and let SettleRagdoll swap remove.
+	for (int32 i = Ragdolls.Num() - 1; i >= 0; --i)
+	{
+		if (i >= Ragdolls.Num())
+		{
+			continue;
+		}
+
+		FCG_Ragdoll & ragdoll = Ragdolls[i];
+		ACG_EnemyCharacter * enemy = ragdoll.Enemy.Get();
+		if (!enemy)
+		{
+			Ragdolls.RemoveAtSwap(i, 1, false);
+			continue;
+		}
+
+		// Nobody is close enough to see the capsule lag behind a dormant enemy
+		if (enemy->GetSignificance() != ESignificance::DORMANT)
+		{
+			enemy->FollowRagdoll();
+		}
+
+		const float elapsed = now - ragdoll.StartTime;
+		if (elapsed < MinRagdollTime)
+		{
+			continue;
+		}
+
+		USkeletalMeshComponent * mesh = enemy->GetMesh();
+		const FName bone = enemy->GetRagdollBone();
+		const float settleSpeed = enemy->GetRagdollSettleSpeed();
+
+		// Physics putting the body to sleep is the surest sign, the speed check catches ragdolls
+		// that jitter on the ground without ever sleeping.
+		bool settled = !mesh->RigidBodyIsAwake(bone);
+		if (!settled)
+		{
+			if (mesh->GetPhysicsLinearVelocity(bone).SizeSquared() < settleSpeed * settleSpeed)
+			{
+				ragdoll.CalmTime += deltaTime;
+			}
+			else
+			{
+				ragdoll.CalmTime = 0.0f;
+			}
+
+			settled = (ragdoll.CalmTime >= SettleTime) || (elapsed >= MaxRagdollTime);
+		}
+
+		if (settled)
+		{
+			SettleRagdoll(i);
+		}
+	}
+
+	CG_SET_DWORD_STAT(STAT_NumRagdolls, Ragdolls.Num());
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_RagdollSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_RagdollSubsystem::IsTickable() const
+{
+	return IsInitialized() && Ragdolls.Num() > 0;
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_RagdollSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_RagdollSubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_RagdollSubsystem::AddRagdoll(ACG_EnemyCharacter * enemy)
+{
+	check(IsInGameThread());
+	check(enemy);
+
+	for (FCG_Ragdoll & ragdoll : Ragdolls)
+	{
+		if (ragdoll.Enemy.Get() == enemy)
+		{
+			// Hit again while already down, only counts as fresh for settling
+			ragdoll.CalmTime = 0.0f;
+			return true;
+		}
+	}
+
+	if (Ragdolls.Num() >= MaxActiveRagdolls)
+	{
+		const int32 candidate = FindEvictionCandidate();
+		const ACG_EnemyCharacter * evicted = Ragdolls[candidate].Enemy.Get();
+		if (evicted && evicted->GetSignificance() < enemy->GetSignificance())
+		{
+			INC_DWORD_STAT(STAT_RagdollsRefused);
+			return false;
+		}
+
+		INC_DWORD_STAT(STAT_RagdollsEvicted);
+		SettleRagdoll(candidate);
+	}
+
+	FCG_Ragdoll & ragdoll = Ragdolls.AddDefaulted_GetRef();
+	ragdoll.Enemy = enemy;
+	ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+	ragdoll.CalmTime = 0.0f;
+
+	enemy->EnterRagdoll();
+	return true;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_RagdollSubsystem::RemoveRagdoll(ACG_EnemyCharacter * enemy)
+{
+	for (int32 i = 0; i < Ragdolls.Num(); ++i)
+	{
+		if (Ragdolls[i].Enemy.GetEvenIfUnreachable() == enemy)
+		{
+			Ragdolls.RemoveAtSwap(i, 1, false);
+			return;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+int32 UCG_RagdollSubsystem::FindEvictionCandidate() const
+{
+	// Least significant first, oldest breaks ties. Dead enemies go before anything.
+	int32 candidate = 0;
+	for (int32 i = 0; i < Ragdolls.Num(); ++i)
+	{
+		const ACG_EnemyCharacter * enemy = Ragdolls[i].Enemy.Get();
+		if (!enemy)
+		{
+			return i;
+		}
+
+		const ACG_EnemyCharacter * best = Ragdolls[candidate].Enemy.Get();
+		if (enemy->GetSignificance() > best->GetSignificance() ||
+			(enemy->GetSignificance() == best->GetSignificance() && Ragdolls[i].StartTime < Ragdolls[candidate].StartTime))
+		{
+			candidate = i;
+		}
+	}
+
+	return candidate;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_RagdollSubsystem::SettleRagdoll(int32 index)
+{
+	ACG_EnemyCharacter * enemy = Ragdolls[index].Enemy.Get();
+	Ragdolls.RemoveAtSwap(index, 1, false);
+
+	if (enemy)
+	{
+		enemy->FollowRagdoll();
+		enemy->ExitRagdoll();
+	}
+}
@@ -0,0 +1,86 @@
+// ============================================================
+// FILE: CG_RagdollSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_RagdollSubsystem.generated.h"
+
+class ACG_EnemyCharacter;
+
+// ============================================================
+struct FCG_Ragdoll
+{
+	TWeakObjectPtr<ACG_EnemyCharacter> Enemy;
+	float StartTime;
+
+	// How long the followed body has been below the enemy's settle speed
+	float CalmTime;
+};
+
+// ============================================================
+// Owns every full body ragdoll in the world. Only so many simulate at once, a new one pushes out
+// the least significant (then oldest) when the budget is full. Settling is decided here in one
+// pass a frame from the followed body's sleep state and speed, the capsules are moved along with
+// their ragdolls in the same pass.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_RagdollSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_RagdollSubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// False if the budget is full of ragdolls that matter more than this one, the enemy should
+	// react to the force some other way.
+	bool AddRagdoll(ACG_EnemyCharacter * enemy);
+
+	// Drops the enemy without standing it up, for enemies leaving play
+	void RemoveRagdoll(ACG_EnemyCharacter * enemy);
+
+	FORCEINLINE int32 GetNumRagdolls() const;
+
+protected:
+// ============================================================
+	UPROPERTY(Config)
+	int32 MaxActiveRagdolls;
+
+	// A ragdoll can't settle before this, gives the impulse a chance to land
+	UPROPERTY(Config)
+	float MinRagdollTime;
+
+	// Anything still simulating after this is stood up anyway
+	UPROPERTY(Config)
+	float MaxRagdollTime;
+
+	// How long a ragdoll has to stay under its settle speed to count as settled
+	UPROPERTY(Config)
+	float SettleTime;
+
+private:
+// ============================================================
+	int32 FindEvictionCandidate() const;
+	void SettleRagdoll(int32 index);
+
+// ============================================================
+	TArray<FCG_Ragdoll> Ragdolls;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_RagdollSubsystem::GetNumRagdolls() const
+{
+	return Ragdolls.Num();
+}
+// ============================================================
@@ -0,0 +1,148 @@
+// ============================================================
+// FILE: CG_SceneQuerySubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SceneQuerySubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scene Query Requests"), STAT_SceneQueryRequests, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scene Queries Merged"), STAT_SceneQueriesMerged, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scene Queries Issued"), STAT_SceneQueriesIssued, STATGROUP_CelestialGrove);
+
+// Queries closer than this are treated as the same query
+#define SCENE_QUERY_QUANTIZATION 1.0f
+
+// -----------------------------------------------------------------------------------------
+internal FIntVector QuantizeQueryLocation(const FVector & location)
+{
+	return FIntVector(
+		FMath::RoundToInt(location.X / SCENE_QUERY_QUANTIZATION),
+		FMath::RoundToInt(location.Y / SCENE_QUERY_QUANTIZATION),
+		FMath::RoundToInt(location.Z / SCENE_QUERY_QUANTIZATION));
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SceneQuerySubsystem::Initialize(FSubsystemCollectionBase & collection)
+{
+	Super::Initialize(collection);
+
+	NextQueryId = 0;
+	TraceDelegate.BindUObject(this, &UCG_SceneQuerySubsystem::OnTraceComplete);
+
+	// NOTE(RyanC): Flushing once the actors have ticked gets everything they asked for this frame
+	// into the same async batch.
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UCG_SceneQuerySubsystem::FlushQueries);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SceneQuerySubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+
+	PendingQueries.Empty();
+	PendingLookup.Empty();
+	InFlightQueries.Empty();
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SceneQuerySubsystem::RequestLineTrace(const FVector & start, const FVector & end, ECollisionChannel channel, const AActor * ignoredActor, FCG_TraceQueryDelegate onComplete)
+{
+	check(IsInGameThread());
+	INC_DWORD_STAT(STAT_SceneQueryRequests);
+
+	FCG_SceneQueryKey key;
+	key.Start = QuantizeQueryLocation(start);
+	key.End = QuantizeQueryLocation(end);
+	key.Filter = (uint8)channel;
+	key.IgnoredActor = ignoredActor;
+
+	bool wasAdded;
+	FCG_SceneQuery & query = FindOrAddQuery(key, wasAdded);
+	if (wasAdded)
+	{
+		query.Start = start;
+		query.End = end;
+		query.Channel = channel;
+		query.IgnoredActor = ignoredActor;
+	}
+
+	FCG_SceneQueryRequester & requester = query.Requesters.AddDefaulted_GetRef();
+	requester.OnTrace = MoveTemp(onComplete);
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_SceneQuery & UCG_SceneQuerySubsystem::FindOrAddQuery(const FCG_SceneQueryKey & key, bool & wasAdded)
+{
+	int32 & index = PendingLookup.FindOrAdd(key, INDEX_NONE);
+	wasAdded = (index == INDEX_NONE);
+
+	if (wasAdded)
+	{
+		index = PendingQueries.AddDefaulted();
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_SceneQueriesMerged);
+	}
+
+	return PendingQueries[index];
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SceneQuerySubsystem::FlushQueries(UWorld * world, ELevelTick tickType, float deltaTime)
+{
+	if (world != GetWorld() || PendingQueries.Num() == 0)
+	{
+		return;
+	}
+
+	for (FCG_SceneQuery & query : PendingQueries)
+	{
+		const uint32 queryId = ++NextQueryId;
+
+		FCollisionQueryParams params(SCENE_QUERY_STAT(CG_SpellQuery), false);
+		if (query.IgnoredActor.IsValid())
+		{
+			params.AddIgnoredActor(query.IgnoredActor.Get());
+		}
+
+		world->AsyncLineTraceByChannel(
+									   EAsyncTraceType::Single,
+									   query.Start,
+									   query.End,
+									   query.Channel,
+									   params,
+									   FCollisionResponseParams::DefaultResponseParam,
+									   &TraceDelegate,
+									   queryId
+									  );
+
+		InFlightQueries.Add(queryId, MoveTemp(query));
+		INC_DWORD_STAT(STAT_SceneQueriesIssued);
+	}
+
+	PendingQueries.Reset();
+	PendingLookup.Reset();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SceneQuerySubsystem::OnTraceComplete(const FTraceHandle & handle, FTraceDatum & datum)
+{
+	FCG_SceneQuery query;
+	if (!InFlightQueries.RemoveAndCopyValue(datum.UserData, query))
+	{
+		return;
+	}
+
+	const bool wasHit = datum.OutHits.Num() > 0 && datum.OutHits[0].bBlockingHit;
+	const FHitResult hit = wasHit ? datum.OutHits[0] : FHitResult(query.Start, query.End);
+
+	for (FCG_SceneQueryRequester & requester : query.Requesters)
+	{
+		requester.OnTrace.ExecuteIfBound(wasHit, hit);
+	}
+}
@@ -0,0 +1,91 @@
+// ============================================================
+// FILE: CG_SceneQuerySubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "CG_SceneQuerySubsystem.generated.h"
+
+class AActor;
+
+// ============================================================
+DECLARE_DELEGATE_TwoParams(FCG_TraceQueryDelegate, bool /*wasHit*/, const FHitResult &);
+
+// ============================================================
+// Quantized so two casters asking for the same query a few hundredths of a unit apart still merge
+struct FCG_SceneQueryKey
+{
+	FIntVector Start;
+	FIntVector End;
+	uint8 Filter;
+	const AActor * IgnoredActor;
+
+	FORCEINLINE bool operator==(const FCG_SceneQueryKey & other) const
+	{
+		return Start == other.Start && End == other.End && Filter == other.Filter && IgnoredActor == other.IgnoredActor;
+	}
+
+	friend FORCEINLINE uint32 GetTypeHash(const FCG_SceneQueryKey & key)
+	{
+		uint32 hash = HashCombine(GetTypeHash(key.Start), GetTypeHash(key.End));
+		hash = HashCombine(hash, (uint32)key.Filter);
+		return HashCombine(hash, GetTypeHash(key.IgnoredActor));
+	}
+};
+
+// ============================================================
+struct FCG_SceneQueryRequester
+{
+	FCG_TraceQueryDelegate OnTrace;
+};
+
+// ============================================================
+struct FCG_SceneQuery
+{
+	FVector Start;
+	FVector End;
+	ECollisionChannel Channel;
+	TWeakObjectPtr<const AActor> IgnoredActor;
+
+	TArray<FCG_SceneQueryRequester, TInlineAllocator<1>> Requesters;
+};
+
+// ============================================================
+// Collects the targeting traces made during a frame, merges duplicates and issues them async once
+// the actors have ticked. Results come back through the requester's delegate at the start of the
+// next frame.
+UCLASS()
+class CELESTIALGROVE_API UCG_SceneQuerySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	virtual void Initialize(FSubsystemCollectionBase & collection) override;
+	virtual void Deinitialize() override;
+
+	// Traces are only merged with traces from the same actor, the first blocking hit would differ otherwise.
+	void RequestLineTrace(const FVector & start, const FVector & end, ECollisionChannel channel, const AActor * ignoredActor, FCG_TraceQueryDelegate onComplete);
+
+private:
+// ============================================================
+	FCG_SceneQuery & FindOrAddQuery(const FCG_SceneQueryKey & key, bool & wasAdded);
+	void FlushQueries(UWorld * world, ELevelTick tickType, float deltaTime);
+
+	void OnTraceComplete(const FTraceHandle & handle, FTraceDatum & datum);
+
+// ============================================================
+	TArray<FCG_SceneQuery> PendingQueries;
+	TMap<FCG_SceneQueryKey, int32> PendingLookup;
+
+	// Keyed by the user data the query was issued with
+	TMap<uint32, FCG_SceneQuery> InFlightQueries;
+	uint32 NextQueryId;
+
+	FTraceDelegate TraceDelegate;
+	FDelegateHandle PostActorTickHandle;
+};
@@ -0,0 +1,915 @@
+// ============================================================
+// FILE: CG_SessionRecorderSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SessionRecorderSubsystem.h"
+#include "CG_PlayerCharacter.h"
+#include "CG_EnemyCharacter.h"
+#include "CG_SpellBase.h"
+#include "CG_SpellCore.h"
+#include "CG_Profiling.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("Session Record"), STAT_SessionRecord, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Session Playback"), STAT_SessionPlayback, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Session Bytes"), STAT_SessionBytes, STATGROUP_CelestialGrove);
+
+// 'CGRS'
+#define SESSION_MAGIC 0x53524743
+#define SESSION_VERSION 1
+
+// ============================================================
+// Frame tag bits. A tag with SESSION_REPEAT_BIT set is instead a run of (tag & SESSION_MAX_REPEAT)
+// frames where nothing changed.
+#define SESSION_DELTA_TIME_BIT (1 << RECORDED_AXIS_COUNT)
+#define SESSION_ACTIONS_BIT (1 << (RECORDED_AXIS_COUNT + 1))
+#define SESSION_EVENTS_BIT (1 << (RECORDED_AXIS_COUNT + 2))
+#define SESSION_REPEAT_BIT 0x80
+#define SESSION_MAX_REPEAT 0x7F
+
+static_assert(RECORDED_AXIS_COUNT + 3 <= 7, "Frame tag bits run into the repeat bit");
+static_assert(RECORDED_ACTION_COUNT <= 8, "Actions are a single byte");
+
+// -----------------------------------------------------------------------------------------
+internal uint32 GetFloatBits(float value)
+{
+	uint32 bits;
+	FMemory::Memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+// -----------------------------------------------------------------------------------------
+internal float GetBitsFloat(uint32 bits)
+{
+	float value;
+	FMemory::Memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+// -----------------------------------------------------------------------------------------
+// 7 bits a byte, low bits first, high bit set on every byte but the last
+internal void WriteVarUInt(TArray<uint8> & out, uint64 value)
+{
+	while (value >= 0x80)
+	{
+		out.Add((uint8)(value | 0x80));
+		value >>= 7;
+	}
+
+	out.Add((uint8)value);
+}
+
+// -----------------------------------------------------------------------------------------
+// NOTE(RyanC): Close values share their sign, exponent and top of the mantissa, so the XOR with
+// the last value is mostly high zero bits and the varint drops them.
+internal void WriteFloatDelta(TArray<uint8> & out, float value, float lastValue)
+{
+	WriteVarUInt(out, GetFloatBits(value) ^ GetFloatBits(lastValue));
+}
+
+// -----------------------------------------------------------------------------------------
+internal void WriteFloat(TArray<uint8> & out, float value)
+{
+	const uint32 bits = GetFloatBits(value);
+	out.Add((uint8)bits);
+	out.Add((uint8)(bits >> 8));
+	out.Add((uint8)(bits >> 16));
+	out.Add((uint8)(bits >> 24));
+}
+
+// -----------------------------------------------------------------------------------------
+internal void WriteString(TArray<uint8> & out, const FString & value)
+{
+	FTCHARToUTF8 utf8(*value);
+	WriteVarUInt(out, (uint64)utf8.Length());
+	out.Append((const uint8 *)utf8.Get(), utf8.Length());
+}
+
+// -----------------------------------------------------------------------------------------
+// Every read checks the bounds and flags the stream once it runs past them or reads a bad value,
+// the caller checks the flag once it's done with a record.
+internal uint8 ReadByte(const TArray<uint8> & in, int32 & offset, bool & hasError)
+{
+	if (offset >= in.Num())
+	{
+		hasError = true;
+		return 0;
+	}
+
+	return in[offset++];
+}
+
+// -----------------------------------------------------------------------------------------
+internal uint64 ReadVarUInt(const TArray<uint8> & in, int32 & offset, bool & hasError)
+{
+	uint64 value = 0;
+	for (int32 shift = 0; shift < 64; shift += 7)
+	{
+		const uint8 byte = ReadByte(in, offset, hasError);
+		value |= (uint64)(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0)
+		{
+			return value;
+		}
+	}
+
+	hasError = true;
+	return 0;
+}
+
+// -----------------------------------------------------------------------------------------
+internal float ReadFloatDelta(const TArray<uint8> & in, int32 & offset, bool & hasError, float lastValue)
+{
+	return GetBitsFloat((uint32)ReadVarUInt(in, offset, hasError) ^ GetFloatBits(lastValue));
+}
+
+// -----------------------------------------------------------------------------------------
+internal float ReadFloat(const TArray<uint8> & in, int32 & offset, bool & hasError)
+{
+	uint32 bits = ReadByte(in, offset, hasError);
+	bits |= (uint32)ReadByte(in, offset, hasError) << 8;
+	bits |= (uint32)ReadByte(in, offset, hasError) << 16;
+	bits |= (uint32)ReadByte(in, offset, hasError) << 24;
+	return GetBitsFloat(bits);
+}
+
+// -----------------------------------------------------------------------------------------
+internal FString ReadString(const TArray<uint8> & in, int32 & offset, bool & hasError)
+{
+	const uint64 length = ReadVarUInt(in, offset, hasError);
+	if (hasError || length > (uint64)(in.Num() - offset))
+	{
+		hasError = true;
+		return FString();
+	}
+
+	FUTF8ToTCHAR tchar((const ANSICHAR *)in.GetData() + offset, (int32)length);
+	offset += (int32)length;
+	return FString(tchar.Length(), tchar.Get());
+}
+
+// -----------------------------------------------------------------------------------------
+// Base first, the rest in type order. Only the base's position matters to the fold.
+internal void GetKeyComponents(uint64 key, TArray<ESpellComponentType> & components)
+{
+	// Base first then the effect base, they're the same component when the base is an effect
+	const CGCore::EComponentType base = CGCore::GetKeyBase(key);
+	const CGCore::EComponentType effectBase = CGCore::GetKeyEffectBase(key);
+	components.Add((ESpellComponentType)base);
+	if (effectBase != base)
+	{
+		components.Add((ESpellComponentType)effectBase);
+	}
+
+	for (int32 type = 0; type < CG_CORE_COMPONENT_TYPE_COUNT; ++type)
+	{
+		int32 count = CGCore::GetKeyCount(key, (CGCore::EComponentType)type);
+		if (type == (int32)base)
+		{
+			--count;
+		}
+		if (type == (int32)effectBase && effectBase != base)
+		{
+			--count;
+		}
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			components.Add((ESpellComponentType)type);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+UCG_SessionRecorderSubsystem::UCG_SessionRecorderSubsystem()
+{
+	RecordSessions = false;
+	FlushBytes = 64 * 1024;
+
+	Mode = ESessionMode::NONE;
+	Seed = 0;
+	NumFrames = 0;
+	NumEvents = 0;
+	NumEmptyFrames = 0;
+	NumBytesWritten = 0;
+	HasStartedFrame = false;
+	ReadOffset = 0;
+	RepeatFrames = 0;
+	HasFrame = false;
+	HasStreamError = false;
+	HasSavedTimeStep = false;
+	SavedUseFixedTimeStep = false;
+	SavedFixedDeltaTime = 0.0;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_SessionRecorderSubsystem::ShouldCreateSubsystem(UObject * outer) const
+{
+	// Either switch with or without a file
+	const TCHAR * commandLine = FCommandLine::Get();
+	const bool isRequested = RecordSessions || FCString::Strifind(commandLine, TEXT("-cgrecord")) || FCString::Strifind(commandLine, TEXT("-cgplayback"));
+
+	return isRequested && Super::ShouldCreateSubsystem(outer);
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_SessionRecorderSubsystem::DoesSupportWorldType(const EWorldType::Type worldType) const
+{
+	return worldType == EWorldType::Game || worldType == EWorldType::PIE;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::Initialize(FSubsystemCollectionBase & collection)
+{
+	Super::Initialize(collection);
+
+	// NOTE(RyanC): Decided here rather than at begin play, the player sets up their input (and
+	// registers with us) before the world begins play.
+	const TCHAR * commandLine = FCommandLine::Get();
+	if (FParse::Value(commandLine, TEXT("cgplayback="), SessionPath))
+	{
+		Mode = ESessionMode::PLAYING;
+	}
+	else if (FParse::Value(commandLine, TEXT("cgrecord="), SessionPath) || FParse::Param(commandLine, TEXT("cgrecord")) || RecordSessions)
+	{
+		Mode = ESessionMode::RECORDING;
+	}
+	else
+	{
+		UE_LOG(LogCelestialGrove, Warning, TEXT("Session: -cgplayback needs a session file, -cgplayback=<file>."));
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::OnWorldBeginPlay(UWorld & world)
+{
+	Super::OnWorldBeginPlay(world);
+
+	if (Mode == ESessionMode::RECORDING)
+	{
+		StartRecording(world);
+	}
+	else if (Mode == ESessionMode::PLAYING)
+	{
+		StartPlayback(world);
+	}
+
+	if (Mode == ESessionMode::RECORDING || Mode == ESessionMode::PLAYING)
+	{
+		// NOTE(RyanC): Frames are cut at the start of the world tick, before the player controller
+		// processes input, so played back input lands in the same frame it was recorded in.
+		TickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UCG_SessionRecorderSubsystem::OnWorldTickStart);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+
+	if (Mode == ESessionMode::RECORDING)
+	{
+		FinishRecording();
+	}
+	else if (Mode == ESessionMode::PLAYING)
+	{
+		UE_LOG(LogCelestialGrove, Warning, TEXT("Session: %s was stopped after %d frames, before the end of the session."), *SessionPath, NumFrames);
+	}
+
+	RestoreTimeStep();
+
+	Mode = ESessionMode::NONE;
+	Player = nullptr;
+	Buffer.Empty();
+	EventBuffer.Empty();
+	ClassIndices.Empty();
+	Stream.Empty();
+	FrameEvents.Empty();
+	Classes.Empty();
+	Timings.Empty();
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::RegisterPlayer(ACG_PlayerCharacter * player)
+{
+	if (Player.IsValid() && Player.Get() != player)
+	{
+		UE_LOG(LogCelestialGrove, Warning, TEXT("Session: only one player is recorded, ignoring %s."), *player->GetName());
+		return;
+	}
+
+	Player = player;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::RecordSpellLoadout(int32 slot, const UCG_SpellBase * spell)
+{
+	if (Mode != ESessionMode::RECORDING)
+	{
+		return;
+	}
+
+	const uint64 key = spell->GetCompiledKey();
+	const UClass * spellClass = spell->GetClass();
+	if (RecordedSpellKeys.IsValidIndex(slot) && RecordedSpellKeys[slot] == key && RecordedSpellClasses[slot] == spellClass)
+	{
+		return;
+	}
+
+	if (slot >= RecordedSpellKeys.Num())
+	{
+		RecordedSpellKeys.SetNumZeroed(slot + 1);
+		RecordedSpellClasses.SetNumZeroed(slot + 1);
+	}
+
+	RecordedSpellKeys[slot] = key;
+	RecordedSpellClasses[slot] = spellClass;
+
+	EventBuffer.Add((uint8)ESessionEvent::SPELL_BUILT);
+	WriteVarUInt(EventBuffer, (uint64)slot);
+	WriteClass(spellClass);
+	WriteVarUInt(EventBuffer, key);
+	++NumEvents;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::RecordEnemySpawn(const ACG_EnemyCharacter * enemy)
+{
+	// NOTE(RyanC): Anything loaded with the map (or streamed in with a level) will be there on playback anyway
+	if (Mode != ESessionMode::RECORDING || !GetWorld()->HasBegunPlay() || enemy->HasAnyFlags(RF_WasLoaded))
+	{
+		return;
+	}
+
+	const FVector location = enemy->GetActorLocation();
+
+	EventBuffer.Add((uint8)ESessionEvent::ENEMY_SPAWNED);
+	WriteClass(enemy->GetClass());
+	WriteFloat(EventBuffer, (float)location.X);
+	WriteFloat(EventBuffer, (float)location.Y);
+	WriteFloat(EventBuffer, (float)location.Z);
+	WriteFloat(EventBuffer, (float)enemy->GetActorRotation().Yaw);
+	++NumEvents;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::OnWorldTickStart(UWorld * world, ELevelTick tickType, float deltaTime)
+{
+	if (world != GetWorld())
+	{
+		return;
+	}
+
+	if (Mode == ESessionMode::RECORDING)
+	{
+		CG_SCOPE_CYCLE_COUNTER(STAT_SessionRecord);
+
+		if (HasStartedFrame)
+		{
+			WriteFrame();
+		}
+
+		Frame.DeltaTime = (float)FApp::GetDeltaTime();
+		Frame.Actions = 0;
+		HasStartedFrame = true;
+	}
+	else if (Mode == ESessionMode::PLAYING)
+	{
+		CG_SCOPE_CYCLE_COUNTER(STAT_SessionPlayback);
+
+		Timings.Sample(NumFrames > 0);
+
+		if (!HasFrame)
+		{
+			FinishPlayback();
+			return;
+		}
+
+		PlayFrame();
+
+		// NOTE(RyanC): The next frame's delta time has to be in before the engine starts it
+		HasFrame = ReadFrame();
+		if (HasFrame)
+		{
+			FApp::SetFixedDeltaTime(Frame.DeltaTime);
+		}
+	}
+}
+
+// ============================================================
+// Recording
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::StartRecording(UWorld & world)
+{
+	if (SessionPath.IsEmpty())
+	{
+		SessionPath = FPaths::ProjectSavedDir() / TEXT("Sessions") /
+			FString::Printf(TEXT("%s_%s.cgsession"), *world.GetMapName(), *FDateTime::Now().ToString());
+	}
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*SessionPath));
+	if (!Writer)
+	{
+		UE_LOG(LogCelestialGrove, Error, TEXT("Session: couldn't create %s, not recording."), *SessionPath);
+		Mode = ESessionMode::NONE;
+		return;
+	}
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("cgseed="), Seed))
+	{
+		Seed = (int32)FPlatformTime::Cycles();
+	}
+
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	WriteVarUInt(Buffer, SESSION_MAGIC);
+	WriteVarUInt(Buffer, SESSION_VERSION);
+	WriteVarUInt(Buffer, (uint32)Seed);
+	WriteString(Buffer, world.GetMapName());
+
+	UE_LOG(LogCelestialGrove, Display, TEXT("Session: recording %s to %s, seed %d."), *world.GetMapName(), *SessionPath, Seed);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::WriteFrame()
+{
+	++NumFrames;
+
+	uint8 tag = 0;
+	for (int32 i = 0; i < RECORDED_AXIS_COUNT; ++i)
+	{
+		if (GetFloatBits(Frame.Axes[i]) != GetFloatBits(LastFrame.Axes[i]))
+		{
+			SET_FLAG(tag, (uint8)(1 << i));
+		}
+	}
+
+	if (GetFloatBits(Frame.DeltaTime) != GetFloatBits(LastFrame.DeltaTime))
+	{
+		SET_FLAG(tag, SESSION_DELTA_TIME_BIT);
+	}
+
+	if (Frame.Actions != 0)
+	{
+		SET_FLAG(tag, SESSION_ACTIONS_BIT);
+	}
+
+	if (NumEvents > 0)
+	{
+		SET_FLAG(tag, SESSION_EVENTS_BIT);
+	}
+
+	if (tag == 0)
+	{
+		++NumEmptyFrames;
+		if (NumEmptyFrames == SESSION_MAX_REPEAT)
+		{
+			WriteEmptyFrames();
+		}
+
+		return;
+	}
+
+	WriteEmptyFrames();
+	Buffer.Add(tag);
+
+	for (int32 i = 0; i < RECORDED_AXIS_COUNT; ++i)
+	{
+		if (COMPARE_FLAG(tag, 1 << i))
+		{
+			WriteFloatDelta(Buffer, Frame.Axes[i], LastFrame.Axes[i]);
+		}
+	}
+
+	if (COMPARE_FLAG(tag, SESSION_DELTA_TIME_BIT))
+	{
+		WriteFloatDelta(Buffer, Frame.DeltaTime, LastFrame.DeltaTime);
+	}
+
+	if (COMPARE_FLAG(tag, SESSION_ACTIONS_BIT))
+	{
+		Buffer.Add(Frame.Actions);
+	}
+
+	if (COMPARE_FLAG(tag, SESSION_EVENTS_BIT))
+	{
+		WriteVarUInt(Buffer, (uint64)NumEvents);
+		Buffer.Append(EventBuffer);
+		EventBuffer.Reset();
+		NumEvents = 0;
+	}
+
+	LastFrame = Frame;
+
+	if (Buffer.Num() >= FlushBytes)
+	{
+		FlushRecording();
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::WriteEmptyFrames()
+{
+	if (NumEmptyFrames > 0)
+	{
+		Buffer.Add((uint8)(SESSION_REPEAT_BIT | NumEmptyFrames));
+		NumEmptyFrames = 0;
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+// Classes are written out in full the first time, by index after that
+void UCG_SessionRecorderSubsystem::WriteClass(const UClass * recordedClass)
+{
+	const int32 * index = ClassIndices.Find(recordedClass);
+	if (index)
+	{
+		WriteVarUInt(EventBuffer, (uint64)*index);
+		return;
+	}
+
+	const int32 newIndex = ClassIndices.Num();
+	ClassIndices.Add(recordedClass, newIndex);
+
+	WriteVarUInt(EventBuffer, (uint64)newIndex);
+	WriteString(EventBuffer, recordedClass->GetPathName());
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::FlushRecording()
+{
+	if (Writer && Buffer.Num() > 0)
+	{
+		Writer->Serialize(Buffer.GetData(), Buffer.Num());
+		NumBytesWritten += Buffer.Num();
+		Buffer.Reset();
+
+		CG_SET_DWORD_STAT(STAT_SessionBytes, NumBytesWritten);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::FinishRecording()
+{
+	if (HasStartedFrame)
+	{
+		WriteFrame();
+		HasStartedFrame = false;
+	}
+
+	WriteEmptyFrames();
+	FlushRecording();
+
+	if (Writer)
+	{
+		Writer->Close();
+		Writer.Reset();
+
+		UE_LOG(LogCelestialGrove, Display, TEXT("Session: recorded %d frames to %s (%lld bytes)."), NumFrames, *SessionPath, NumBytesWritten);
+	}
+}
+
+// ============================================================
+// Playback
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::StartPlayback(UWorld & world)
+{
+	if (!FFileHelper::LoadFileToArray(Stream, *SessionPath))
+	{
+		UE_LOG(LogCelestialGrove, Error, TEXT("Session: couldn't read %s, nothing to play back."), *SessionPath);
+		Mode = ESessionMode::NONE;
+		return;
+	}
+
+	ReadOffset = 0;
+	const uint64 magic = ReadVarUInt(Stream, ReadOffset, HasStreamError);
+	const uint64 version = ReadVarUInt(Stream, ReadOffset, HasStreamError);
+	Seed = (int32)ReadVarUInt(Stream, ReadOffset, HasStreamError);
+	const FString mapName = ReadString(Stream, ReadOffset, HasStreamError);
+
+	if (HasStreamError || magic != SESSION_MAGIC || version != SESSION_VERSION)
+	{
+		UE_LOG(LogCelestialGrove, Error, TEXT("Session: %s isn't a version %d session."), *SessionPath, SESSION_VERSION);
+		Mode = ESessionMode::NONE;
+		return;
+	}
+
+	if (mapName != world.GetMapName())
+	{
+		UE_LOG(LogCelestialGrove, Warning, TEXT("Session: %s was recorded on %s, playing it back on %s."), *SessionPath, *mapName, *world.GetMapName());
+	}
+
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+
+	// NOTE(RyanC): Every frame runs with the delta time it was recorded with, set a frame ahead
+	// The time step is the whole engine's, put back once playback is done (PIE keeps running after)
+	HasFrame = ReadFrame();
+	SavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+	SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+	HasSavedTimeStep = true;
+
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(Frame.DeltaTime);
+
+	UE_LOG(LogCelestialGrove, Display, TEXT("Session: playing back %s on %s, seed %d."), *SessionPath, *world.GetMapName(), Seed);
+}
+
+// -----------------------------------------------------------------------------------------
+// Reads the next frame over the last one so anything not written keeps its value. False at the
+// end of the stream or if it's damaged.
+bool UCG_SessionRecorderSubsystem::ReadFrame()
+{
+	Frame.Actions = 0;
+	FrameEvents.Reset();
+
+	if (RepeatFrames > 0)
+	{
+		--RepeatFrames;
+		return true;
+	}
+
+	if (ReadOffset >= Stream.Num() || HasStreamError)
+	{
+		return false;
+	}
+
+	const uint8 tag = ReadByte(Stream, ReadOffset, HasStreamError);
+	if (COMPARE_FLAG(tag, SESSION_REPEAT_BIT))
+	{
+		RepeatFrames = (tag & SESSION_MAX_REPEAT) - 1;
+		HasStreamError = (RepeatFrames < 0);
+		return !HasStreamError;
+	}
+
+	for (int32 i = 0; i < RECORDED_AXIS_COUNT; ++i)
+	{
+		if (COMPARE_FLAG(tag, 1 << i))
+		{
+			Frame.Axes[i] = ReadFloatDelta(Stream, ReadOffset, HasStreamError, Frame.Axes[i]);
+		}
+	}
+
+	if (COMPARE_FLAG(tag, SESSION_DELTA_TIME_BIT))
+	{
+		Frame.DeltaTime = ReadFloatDelta(Stream, ReadOffset, HasStreamError, Frame.DeltaTime);
+	}
+
+	if (COMPARE_FLAG(tag, SESSION_ACTIONS_BIT))
+	{
+		Frame.Actions = ReadByte(Stream, ReadOffset, HasStreamError);
+	}
+
+	if (COMPARE_FLAG(tag, SESSION_EVENTS_BIT))
+	{
+		const uint64 numEvents = ReadVarUInt(Stream, ReadOffset, HasStreamError);
+		for (uint64 i = 0; i < numEvents && !HasStreamError; ++i)
+		{
+			ReadEvent(FrameEvents.AddDefaulted_GetRef());
+		}
+	}
+
+	if (HasStreamError)
+	{
+		UE_LOG(LogCelestialGrove, Error, TEXT("Session: %s is damaged at byte %d, stopping playback there."), *SessionPath, ReadOffset);
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_SessionRecorderSubsystem::ReadEvent(FCG_SessionEvent & event)
+{
+	event.Type = (ESessionEvent)ReadByte(Stream, ReadOffset, HasStreamError);
+
+	switch (event.Type)
+	{
+		case ESessionEvent::SPELL_BUILT:
+			event.Slot = (int32)ReadVarUInt(Stream, ReadOffset, HasStreamError);
+			ReadClass(event.ClassIndex);
+			event.Key = ReadVarUInt(Stream, ReadOffset, HasStreamError);
+			break;
+
+		case ESessionEvent::ENEMY_SPAWNED:
+			ReadClass(event.ClassIndex);
+			event.Location.X = ReadFloat(Stream, ReadOffset, HasStreamError);
+			event.Location.Y = ReadFloat(Stream, ReadOffset, HasStreamError);
+			event.Location.Z = ReadFloat(Stream, ReadOffset, HasStreamError);
+			event.Yaw = ReadFloat(Stream, ReadOffset, HasStreamError);
+			break;
+
+		default:
+			HasStreamError = true;
+			break;
+	}
+
+	return !HasStreamError;
+}
+
+// -----------------------------------------------------------------------------------------
+UClass * UCG_SessionRecorderSubsystem::ReadClass(int32 & index)
+{
+	const uint64 readIndex = ReadVarUInt(Stream, ReadOffset, HasStreamError);
+	if (HasStreamError || readIndex > (uint64)Classes.Num())
+	{
+		HasStreamError = true;
+		index = INDEX_NONE;
+		return nullptr;
+	}
+
+	index = (int32)readIndex;
+	if (index == Classes.Num())
+	{
+		const FString path = ReadString(Stream, ReadOffset, HasStreamError);
+		UClass * loadedClass = FSoftClassPath(path).TryLoadClass<UObject>();
+		if (!loadedClass)
+		{
+			UE_LOG(LogCelestialGrove, Warning, TEXT("Session: couldn't load %s, skipping everything recorded with it."), *path);
+		}
+
+		Classes.Add(loadedClass);
+	}
+
+	return Classes[index];
+}
+
+// -----------------------------------------------------------------------------------------
+// Events first so a spell built on this frame is the one cast, then the axes the same way the
+// input component calls them every frame, then the actions.
+void UCG_SessionRecorderSubsystem::PlayFrame()
+{
+	++NumFrames;
+
+	for (const FCG_SessionEvent & event : FrameEvents)
+	{
+		PlayEvent(event);
+	}
+
+	ACG_PlayerCharacter * player = Player.Get();
+	if (!player)
+	{
+		return;
+	}
+
+	player->MoveForward(Frame.Axes[(int32)ERecordedAxis::MOVE_FORWARD]);
+	player->MoveRight(Frame.Axes[(int32)ERecordedAxis::MOVE_RIGHT]);
+	player->Turn(Frame.Axes[(int32)ERecordedAxis::TURN]);
+	player->LookUp(Frame.Axes[(int32)ERecordedAxis::LOOK_UP]);
+
+	if (Frame.Actions == 0)
+	{
+		return;
+	}
+
+	if (COMPARE_FLAG(Frame.Actions, 1 << (int32)ERecordedAction::INTERACT))
+	{
+		player->Interact();
+	}
+
+	if (COMPARE_FLAG(Frame.Actions, 1 << (int32)ERecordedAction::CAST_SPELL))
+	{
+		player->CastSpell();
+	}
+
+	if (COMPARE_FLAG(Frame.Actions, 1 << (int32)ERecordedAction::START_INSPECTION_DRAG))
+	{
+		player->StartInspectionRotation();
+	}
+
+	if (COMPARE_FLAG(Frame.Actions, 1 << (int32)ERecordedAction::STOP_INSPECTION_DRAG))
+	{
+		player->StopInspectionRotation();
+	}
+
+	// NOTE(RyanC): Only bound while inspecting, checked anyway since ending an inspection that
+	// never started asserts.
+	if (COMPARE_FLAG(Frame.Actions, 1 << (int32)ERecordedAction::QUIT_INSPECTION) && player->CurrentState == EPlayerState::INSPECTING)
+	{
+		player->InspectionEnded();
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::PlayEvent(const FCG_SessionEvent & event)
+{
+	UClass * eventClass = Classes.IsValidIndex(event.ClassIndex) ? Classes[event.ClassIndex] : nullptr;
+	if (!eventClass)
+	{
+		return;
+	}
+
+	switch (event.Type)
+	{
+		case ESessionEvent::SPELL_BUILT:
+		{
+			ACG_PlayerCharacter * player = Player.Get();
+			if (!player || !eventClass->IsChildOf(UCG_SpellBase::StaticClass()))
+			{
+				break;
+			}
+
+			if (event.Slot >= player->EquippedSpells.Num())
+			{
+				player->EquippedSpells.SetNum(event.Slot + 1);
+			}
+
+			UCG_SpellBase * spell = player->EquippedSpells[event.Slot];
+			if (spell && spell->GetClass() == eventClass && spell->GetCompiledKey() == event.Key)
+			{
+				break;
+			}
+
+			if (!spell || spell->GetClass() != eventClass)
+			{
+				spell = NewObject<UCG_SpellBase>(player, eventClass);
+				player->EquippedSpells[event.Slot] = spell;
+			}
+
+			TArray<ESpellComponentType> components;
+			GetKeyComponents(event.Key, components);
+			spell->BuildSpellFromTypes(components);
+		}
+		break;
+
+		case ESessionEvent::ENEMY_SPAWNED:
+		{
+			if (!eventClass->IsChildOf(ACG_EnemyCharacter::StaticClass()))
+			{
+				break;
+			}
+
+			FActorSpawnParameters params;
+			params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			const FRotator rotation(0.0f, event.Yaw, 0.0f);
+			GetWorld()->SpawnActor<ACG_EnemyCharacter>(eventClass, event.Location, rotation, params);
+		}
+		break;
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::FinishPlayback()
+{
+	Mode = ESessionMode::FINISHED;
+	FWorldDelegates::OnWorldTickStart.Remove(TickStartHandle);
+	RestoreTimeStep();
+
+	FString outputPath;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("benchmarkout="), outputPath))
+	{
+		outputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FPaths::GetBaseFilename(SessionPath) + TEXT("_playback.json");
+	}
+
+	FString output;
+	TSharedRef<FCG_BenchmarkJsonWriter> writer = FCG_BenchmarkJsonWriter::Create(&output);
+
+	writer->WriteObjectStart();
+	writer->WriteValue(TEXT("map"), GetWorld()->GetMapName());
+	writer->WriteValue(TEXT("build"), LexToString(FApp::GetBuildConfiguration()));
+	writer->WriteValue(TEXT("session"), FPaths::GetCleanFilename(SessionPath));
+	writer->WriteValue(TEXT("seed"), Seed);
+	writer->WriteValue(TEXT("frames"), NumFrames);
+	writer->WriteValue(TEXT("measuredFrames"), Timings.GetNumFrames());
+	Timings.Write(*writer);
+	writer->WriteObjectEnd();
+	writer->Close();
+
+	if (FFileHelper::SaveStringToFile(output, *outputPath))
+	{
+		UE_LOG(LogCelestialGrove, Display, TEXT("Session: played back %d frames of %s, results written to %s"), NumFrames, *SessionPath, *outputPath);
+	}
+	else
+	{
+		UE_LOG(LogCelestialGrove, Error, TEXT("Session: couldn't write playback results to %s"), *outputPath);
+	}
+
+	if (FApp::IsUnattended())
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SessionRecorderSubsystem::RestoreTimeStep()
+{
+	if (HasSavedTimeStep)
+	{
+		FApp::SetUseFixedTimeStep(SavedUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+		HasSavedTimeStep = false;
+	}
+}
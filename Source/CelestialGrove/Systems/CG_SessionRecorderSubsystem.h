@@ -0,0 +1,252 @@
+// ============================================================
+// FILE: CG_SessionRecorderSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_FrameTimings.h"
+#include "CG_SessionRecorderSubsystem.generated.h"
+
+class ACG_PlayerCharacter;
+class ACG_EnemyCharacter;
+class UCG_SpellBase;
+
+// ============================================================
+// The player's bound axes, recorded with whatever value they had on the frame
+enum class ERecordedAxis : uint8
+{
+	MOVE_FORWARD = 0,
+	MOVE_RIGHT,
+	TURN,
+	LOOK_UP
+};
+
+#define RECORDED_AXIS_COUNT ((int32)ERecordedAxis::LOOK_UP + 1)
+
+// ============================================================
+// Bit per action in a frame's action byte, played back in this order
+enum class ERecordedAction : uint8
+{
+	INTERACT = 0,
+	CAST_SPELL,
+	START_INSPECTION_DRAG,
+	STOP_INSPECTION_DRAG,
+	QUIT_INSPECTION
+};
+
+#define RECORDED_ACTION_COUNT ((int32)ERecordedAction::QUIT_INSPECTION + 1)
+
+// ============================================================
+enum class ESessionEvent : uint8
+{
+	// A spell was cast from a slot whose components or class changed since it was last recorded
+	SPELL_BUILT = 0,
+
+	// An enemy was spawned during play, enemies placed in the map aren't recorded
+	ENEMY_SPAWNED
+};
+
+// ============================================================
+enum class ESessionMode : uint8
+{
+	NONE = 0,
+	RECORDING,
+	PLAYING,
+	FINISHED
+};
+
+// ============================================================
+struct FCG_SessionFrame
+{
+	float Axes[RECORDED_AXIS_COUNT] = {};
+
+	// FApp's delta time, before time dilation
+	float DeltaTime = 0.0f;
+
+	// Bit (1 << ERecordedAction)
+	uint8 Actions = 0;
+};
+
+// ============================================================
+struct FCG_SessionEvent
+{
+	ESessionEvent Type;
+	int32 ClassIndex;
+
+	// SPELL_BUILT
+	int32 Slot;
+	uint64 Key;
+
+	// ENEMY_SPAWNED
+	FVector Location;
+	float Yaw;
+};
+
+// ============================================================
+// Records the local player's input, the spells they build and the enemies spawned during play into
+// a compact binary session, and plays a session back headless through the same input events. A
+// played back session writes out the same frame timings as -benchmark, so any capture that shows
+// a problem can be rerun as a benchmark.
+//
+//   CelestialGrove <Map> -game -cgrecord[=<file>] [-cgseed=N]
+//   CelestialGrove <Map> -game -nullrhi -nosound -unattended -cgplayback=<file> [-benchmarkout=<file>]
+//
+// Sessions are a header (seed and map) then a record per frame. Values are only written when they
+// change, as the XOR with their last value so small changes pack into fewer bytes, and runs of
+// frames where nothing changed collapse into a single byte. Playback puts the engine on a fixed
+// time step with each frame's recorded delta time and seeds FMath's random streams with the
+// recorded seed.
+//
+// Only exists when asked for on the command line or with RecordSessions, the player and enemies
+// don't pay anything for it otherwise.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_SessionRecorderSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_SessionRecorderSubsystem();
+
+	virtual bool ShouldCreateSubsystem(UObject * outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase & collection) override;
+	virtual void OnWorldBeginPlay(UWorld & world) override;
+	virtual void Deinitialize() override;
+
+	// The locally controlled player, input is recorded from and played back into them
+	void RegisterPlayer(ACG_PlayerCharacter * player);
+
+	// Only records when the spell's components or class differ from what was last recorded for the slot
+	void RecordSpellLoadout(int32 slot, const UCG_SpellBase * spell);
+	void RecordEnemySpawn(const ACG_EnemyCharacter * enemy);
+
+	FORCEINLINE void RecordAxis(ERecordedAxis axis, float value);
+	FORCEINLINE void RecordAction(ERecordedAction action);
+
+	FORCEINLINE bool IsRecording() const;
+
+	// Blueprint spawners should stand down while this is true, playback spawns the recorded enemies itself
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE bool IsPlayingBack() const;
+
+	// Seed FRandomStreams from this for anything that should come out the same on playback
+	UFUNCTION(BlueprintCallable)
+	FORCEINLINE int32 GetSessionSeed() const;
+
+protected:
+// ============================================================
+	virtual bool DoesSupportWorldType(const EWorldType::Type worldType) const override;
+
+// ============================================================
+	// Record every session, not just the ones started with -cgrecord
+	UPROPERTY(Config)
+	bool RecordSessions;
+
+	// Recorded bytes are written to the file once this many have built up
+	UPROPERTY(Config)
+	int32 FlushBytes;
+
+private:
+// ============================================================
+	void OnWorldTickStart(UWorld * world, ELevelTick tickType, float deltaTime);
+
+	void StartRecording(UWorld & world);
+	void WriteFrame();
+	void WriteEmptyFrames();
+	void WriteClass(const UClass * recordedClass);
+	void FlushRecording();
+	void FinishRecording();
+
+	void StartPlayback(UWorld & world);
+	bool ReadFrame();
+	bool ReadEvent(FCG_SessionEvent & event);
+	UClass * ReadClass(int32 & index);
+	void PlayFrame();
+	void PlayEvent(const FCG_SessionEvent & event);
+	void FinishPlayback();
+	void RestoreTimeStep();
+
+// ============================================================
+	TWeakObjectPtr<ACG_PlayerCharacter> Player;
+
+	FString SessionPath;
+	ESessionMode Mode;
+	int32 Seed;
+	int32 NumFrames;
+
+	// The frame being recorded or played and the values the next frame is delta encoded against
+	FCG_SessionFrame Frame;
+	FCG_SessionFrame LastFrame;
+
+	FDelegateHandle TickStartHandle;
+
+	// ============================================================
+	// Recording
+	TUniquePtr<FArchive> Writer;
+	TArray<uint8> Buffer;
+
+	// This frame's events, written after the frame's values
+	TArray<uint8> EventBuffer;
+	int32 NumEvents;
+	int32 NumEmptyFrames;
+
+	TMap<const UClass *, int32> ClassIndices;
+	TArray<uint64> RecordedSpellKeys;
+	TArray<const UClass *> RecordedSpellClasses;
+	int64 NumBytesWritten;
+	bool HasStartedFrame;
+
+	// ============================================================
+	// Playback
+	TArray<uint8> Stream;
+	int32 ReadOffset;
+	int32 RepeatFrames;
+	bool HasFrame;
+	bool HasStreamError;
+
+	// FApp's time step from before playback took it over
+	double SavedFixedDeltaTime;
+	bool SavedUseFixedTimeStep;
+	bool HasSavedTimeStep;
+
+	TArray<FCG_SessionEvent> FrameEvents;
+
+	// Index is what the session refers to them by, null if the class couldn't be loaded
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UClass>> Classes;
+
+	FCG_FrameTimings Timings;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE void UCG_SessionRecorderSubsystem::RecordAxis(ERecordedAxis axis, float value)
+{
+	Frame.Axes[(int32)axis] = value;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE void UCG_SessionRecorderSubsystem::RecordAction(ERecordedAction action)
+{
+	SET_FLAG(Frame.Actions, (uint8)(1 << (int32)action));
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool UCG_SessionRecorderSubsystem::IsRecording() const
+{
+	return Mode == ESessionMode::RECORDING;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool UCG_SessionRecorderSubsystem::IsPlayingBack() const
+{
+	return Mode == ESessionMode::PLAYING;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_SessionRecorderSubsystem::GetSessionSeed() const
+{
+	return Seed;
+}
+// ============================================================
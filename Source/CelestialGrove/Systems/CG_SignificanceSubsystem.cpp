@@ -0,0 +1,218 @@
+// ============================================================
+// FILE: CG_SignificanceSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SignificanceSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_EnemyCharacter.h"
+#include "GameFramework/PlayerController.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_SignificanceUpdate, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Near"), STAT_NumEnemiesNear, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Mid"), STAT_NumEnemiesMid, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Far"), STAT_NumEnemiesFar, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies Dormant"), STAT_NumEnemiesDormant, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+UCG_SignificanceSubsystem::UCG_SignificanceSubsystem()
+{
+	NearDistance = 1500.0f;
+	MidDistance = 4000.0f;
+	FarDistance = 8000.0f;
+
+	NearTickInterval = 0.0f;
+	MidTickInterval = 0.1f;
+	FarTickInterval = 0.5f;
+
+	OffscreenTime = 0.5f;
+	Hysteresis = 0.1f;
+	EvaluationsPerFrame = 128;
+
+	NextToEvaluate = 0;
+	FMemory::Memzero(BucketCounts);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SignificanceSubsystem::Deinitialize()
+{
+	Enemies.Empty();
+	Significances.Empty();
+	EnemyToIndex.Empty();
+	ViewLocations.Empty();
+	NextToEvaluate = 0;
+	FMemory::Memzero(BucketCounts);
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SignificanceSubsystem::Tick(float deltaTime)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_SignificanceUpdate);
+	Super::Tick(deltaTime);
+
+	GatherViewLocations();
+	if (ViewLocations.Num() == 0)
+	{
+		// Nobody to be significant to, leave everything where it is
+		return;
+	}
+
+	const int32 numToEvaluate = FMath::Min(EvaluationsPerFrame, Enemies.Num());
+	for (int32 i = 0; i < numToEvaluate; ++i)
+	{
+		if (NextToEvaluate >= Enemies.Num())
+		{
+			NextToEvaluate = 0;
+		}
+
+		const int32 index = NextToEvaluate++;
+		const ACG_EnemyCharacter * enemy = Enemies[index].Get();
+		if (!enemy)
+		{
+			continue;
+		}
+
+		ESignificance significance = Evaluate(*enemy, Significances[index]);
+		if (significance != Significances[index])
+		{
+			SetSignificance(index, significance);
+		}
+	}
+
+	CG_SET_DWORD_STAT(STAT_NumEnemiesNear, BucketCounts[(int32)ESignificance::NEAR]);
+	CG_SET_DWORD_STAT(STAT_NumEnemiesMid, BucketCounts[(int32)ESignificance::MID]);
+	CG_SET_DWORD_STAT(STAT_NumEnemiesFar, BucketCounts[(int32)ESignificance::FAR]);
+	CG_SET_DWORD_STAT(STAT_NumEnemiesDormant, BucketCounts[(int32)ESignificance::DORMANT]);
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_SignificanceSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_SignificanceSubsystem::IsTickable() const
+{
+	return IsInitialized() && Enemies.Num() > 0;
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_SignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_SignificanceSubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SignificanceSubsystem::RegisterEnemy(ACG_EnemyCharacter * enemy)
+{
+	check(IsInGameThread());
+	check(enemy);
+
+	if (EnemyToIndex.Contains(enemy))
+	{
+		return;
+	}
+
+	// NOTE(RyanC): Placed enemies all register on the first frame, evaluating them here means the
+	// level never pays for 500 full ticks while the slices catch up. Nothing has rendered yet so
+	// everything starts a bucket lower than it will settle at.
+	GatherViewLocations();
+	ESignificance significance = (ViewLocations.Num() > 0) ? Evaluate(*enemy, ESignificance::DORMANT) : ESignificance::NEAR;
+
+	int32 index = Enemies.Emplace(enemy);
+	Significances.Emplace(significance);
+	EnemyToIndex.Add(enemy, index);
+	++BucketCounts[(int32)significance];
+
+	enemy->SetSignificance(significance);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SignificanceSubsystem::UnregisterEnemy(ACG_EnemyCharacter * enemy)
+{
+	check(IsInGameThread());
+
+	int32 index;
+	if (!EnemyToIndex.RemoveAndCopyValue(enemy, index))
+	{
+		return;
+	}
+
+	--BucketCounts[(int32)Significances[index]];
+
+	const int32 last = Enemies.Num() - 1;
+	if (index != last)
+	{
+		EnemyToIndex[Enemies[last].GetEvenIfUnreachable()] = index;
+	}
+
+	Enemies.RemoveAtSwap(index, 1, false);
+	Significances.RemoveAtSwap(index, 1, false);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SignificanceSubsystem::GatherViewLocations()
+{
+	ViewLocations.Reset();
+
+	for (FConstPlayerControllerIterator it = GetWorld()->GetPlayerControllerIterator(); it; ++it)
+	{
+		const APlayerController * controller = it->Get();
+		if (!controller || !controller->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector location;
+		FRotator rotation;
+		controller->GetPlayerViewPoint(location, rotation);
+		ViewLocations.Emplace(location);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+ESignificance UCG_SignificanceSubsystem::Evaluate(const ACG_EnemyCharacter & enemy, ESignificance current) const
+{
+	const FVector location = enemy.GetActorLocation();
+
+	float distSq = MAX_flt;
+	for (const FVector & view : ViewLocations)
+	{
+		distSq = FMath::Min(distSq, (float)FVector::DistSquared(view, location));
+	}
+
+	const float distances[] = { NearDistance, MidDistance, FarDistance };
+
+	int32 bucket = (int32)ESignificance::DORMANT;
+	for (int32 i = 0; i < UE_ARRAY_COUNT(distances); ++i)
+	{
+		// Only the edges at or past the current bucket get stretched, moving in is never delayed
+		float distance = (i >= (int32)current) ? distances[i] * (1.0f + Hysteresis) : distances[i];
+		if (distSq <= distance * distance)
+		{
+			bucket = i;
+			break;
+		}
+	}
+
+	if (bucket < (int32)ESignificance::DORMANT && !enemy.WasRecentlyRendered(OffscreenTime))
+	{
+		++bucket;
+	}
+
+	return (ESignificance)bucket;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SignificanceSubsystem::SetSignificance(int32 index, ESignificance significance)
+{
+	--BucketCounts[(int32)Significances[index]];
+	++BucketCounts[(int32)significance];
+	Significances[index] = significance;
+
+	Enemies[index]->SetSignificance(significance);
+}
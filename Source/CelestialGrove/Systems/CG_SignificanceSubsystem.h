@@ -0,0 +1,129 @@
+// ============================================================
+// FILE: CG_SignificanceSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_SignificanceSubsystem.generated.h"
+
+class ACG_EnemyCharacter;
+
+// ============================================================
+// Most significant first, DORMANT doesn't tick at all
+enum class ESignificance : uint8
+{
+	NEAR = 0,
+	MID,
+	FAR,
+	DORMANT
+};
+
+#define SIGNIFICANCE_COUNT 4
+
+// ============================================================
+// Buckets every enemy by its distance to the closest local player's view and whether it has
+// been on screen lately, each bucket ticks at its own interval. Enemies are re-evaluated a slice
+// at a time so the cost stays flat however many are placed in the level.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_SignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_SignificanceSubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// The enemy is given its starting significance straight away
+	void RegisterEnemy(ACG_EnemyCharacter * enemy);
+	void UnregisterEnemy(ACG_EnemyCharacter * enemy);
+
+	// Zero means every frame, only meaningful for buckets that tick
+	FORCEINLINE float GetTickInterval(ESignificance significance) const;
+	FORCEINLINE int32 GetNumInBucket(ESignificance significance) const;
+
+protected:
+// ============================================================
+	// Furthest an enemy can be from a player's view and still be in the bucket, past FarDistance is dormant
+	UPROPERTY(Config)
+	float NearDistance;
+
+	UPROPERTY(Config)
+	float MidDistance;
+
+	UPROPERTY(Config)
+	float FarDistance;
+
+	UPROPERTY(Config)
+	float NearTickInterval;
+
+	UPROPERTY(Config)
+	float MidTickInterval;
+
+	UPROPERTY(Config)
+	float FarTickInterval;
+
+	// Enemies that haven't rendered for this long drop one bucket
+	UPROPERTY(Config)
+	float OffscreenTime;
+
+	// Fraction a bucket's distance is stretched by before an enemy in it drops out, stops enemies
+	// sitting on a boundary from flipping every evaluation
+	UPROPERTY(Config)
+	float Hysteresis;
+
+	UPROPERTY(Config)
+	int32 EvaluationsPerFrame;
+
+private:
+// ============================================================
+	void GatherViewLocations();
+	ESignificance Evaluate(const ACG_EnemyCharacter & enemy, ESignificance current) const;
+	void SetSignificance(int32 index, ESignificance significance);
+
+// ============================================================
+	// Packed, swap removed
+	TArray<TWeakObjectPtr<ACG_EnemyCharacter>> Enemies;
+	TArray<ESignificance> Significances;
+
+	TMap<const ACG_EnemyCharacter *, int32> EnemyToIndex;
+
+	// Where the next slice of evaluations starts
+	int32 NextToEvaluate;
+	int32 BucketCounts[SIGNIFICANCE_COUNT];
+
+	// Gathered once a frame, split screen has more than one
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_SignificanceSubsystem::GetTickInterval(ESignificance significance) const
+{
+	switch (significance)
+	{
+		case ESignificance::NEAR:
+			return NearTickInterval;
+
+		case ESignificance::MID:
+			return MidTickInterval;
+
+		default:
+			return FarTickInterval;
+	}
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_SignificanceSubsystem::GetNumInBucket(ESignificance significance) const
+{
+	return BucketCounts[(int32)significance];
+}
+// ============================================================
@@ -0,0 +1,175 @@
+// ============================================================
+// FILE: CG_SpellComponentRegistry.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SpellComponentRegistry.h"
+#include "Engine/DataTable.h"
+#include "Engine/Engine.h"
+#include "CG_CompiledSpell.h"
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellComponentRegistry::Initialize(FSubsystemCollectionBase & collection)
+{
+	Super::Initialize(collection);
+
+	LoadedTable = ComponentTable.LoadSynchronous();
+	if (!LoadedTable)
+	{
+		UE_LOG(LogCelestialGrove, Error, TEXT("Spell component table %s failed to load, spells won't build."), *ComponentTable.ToString());
+	}
+
+	BuildTables();
+
+#if WITH_EDITOR
+	// Designers edit the table while the editor is running so keep the flat copy up to date
+	if (LoadedTable)
+	{
+		LoadedTable->OnDataTableChanged().AddUObject(this, &UCG_SpellComponentRegistry::BuildTables);
+	}
+#endif // WITH_EDITOR
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellComponentRegistry::Deinitialize()
+{
+#if WITH_EDITOR
+	if (LoadedTable)
+	{
+		LoadedTable->OnDataTableChanged().RemoveAll(this);
+	}
+#endif // WITH_EDITOR
+
+	LoadedTable = nullptr;
+	FMemory::Memzero(Rows);
+	RegisteredMask = 0;
+
+	for (TWeakPtr<FStreamableHandle> & handle : AssetHandles)
+	{
+		handle.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+UCG_SpellComponentRegistry * UCG_SpellComponentRegistry::Get()
+{
+	check(GEngine);
+	return GEngine->GetEngineSubsystem<UCG_SpellComponentRegistry>();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellComponentRegistry::BuildTables()
+{
+	for (int32 i = 0; i < SPELL_COMPONENT_TYPE_COUNT; ++i)
+	{
+		Stats[i] = FCG_SpellComponentStats();
+		Stats[i].Type = (ESpellComponentType)i;
+	}
+
+	FMemory::Memzero(Rows);
+	RegisteredMask = 0;
+
+	// NOTE(RyanC): Spells already holding a handle keep their assets, new requests go by the new rows.
+	for (TWeakPtr<FStreamableHandle> & handle : AssetHandles)
+	{
+		handle.Reset();
+	}
+
+	if (LoadedTable)
+	{
+		TArray<FCG_SpellComponent *> rows;
+		LoadedTable->GetAllRows<FCG_SpellComponent>(TEXT("UCG_SpellComponentRegistry::BuildTables"), rows);
+
+		for (const FCG_SpellComponent * row : rows)
+		{
+			int32 index = (int32)row->Type;
+			check(index < SPELL_COMPONENT_TYPE_COUNT);
+
+			if (Rows[index])
+			{
+				UE_LOG(LogCelestialGrove, Warning, TEXT("Spell component %s has more than one row, using the first."), *UEnum::GetValueAsString(row->Type));
+				continue;
+			}
+
+			FCG_SpellComponentStats & stats = Stats[index];
+			stats.Category = row->Category;
+			stats.BaseEffectStrength = row->BaseEffectStrength;
+			stats.BaseTargetStrength = row->BaseTargetStrenth;
+			stats.BaseCooldown = row->BaseCooldown;
+			stats.EffectModifier = row->EffectModifier;
+			stats.TargetModifier = row->TargetModifier;
+			stats.CooldownModifier = row->CooldownModifier;
+
+			Rows[index] = row;
+			SET_FLAG(RegisteredMask, (uint16)(1 << index));
+		}
+	}
+
+	// Anything compiled from the old values is stale now
+	FCG_CompiledSpell::ResetCache();
+}
+
+// -----------------------------------------------------------------------------------------
+TSharedPtr<FStreamableHandle> UCG_SpellComponentRegistry::RequestComponentAssets(ESpellComponentType type)
+{
+	check(IsInGameThread());
+
+	TWeakPtr<FStreamableHandle> & cached = AssetHandles[(int32)type];
+	TSharedPtr<FStreamableHandle> handle = cached.Pin();
+	if (handle.IsValid())
+	{
+		return handle;
+	}
+
+	const FCG_SpellComponent * row = Rows[(int32)type];
+	if (!row)
+	{
+		return nullptr;
+	}
+
+	TArray<FSoftObjectPath, TInlineAllocator<3>> assets;
+	if (!row->BaseEffect.IsNull())
+	{
+		assets.Emplace(row->BaseEffect.ToSoftObjectPath());
+	}
+	if (!row->BaseSfx.IsNull())
+	{
+		assets.Emplace(row->BaseSfx.ToSoftObjectPath());
+	}
+	if (!row->Symbol.IsNull())
+	{
+		assets.Emplace(row->Symbol.ToSoftObjectPath());
+	}
+
+	if (assets.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	handle = StreamableManager.RequestAsyncLoad(TArray<FSoftObjectPath>(assets), FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+	cached = handle;
+	return handle;
+}
+
+// -----------------------------------------------------------------------------------------
+const FCG_SpellComponent & UCG_SpellComponentRegistry::GetComponentRow(ESpellComponentType type) const
+{
+	static const FCG_SpellComponent missingRow;
+
+	const FCG_SpellComponent * row = Rows[(int32)type];
+	return row ? *row : missingRow;
+}
+
+// -----------------------------------------------------------------------------------------
+FText UCG_SpellComponentRegistry::GetComponentPhonetic(ESpellComponentType type) const
+{
+	return GetComponentRow(type).Phonetic;
+}
+
+// -----------------------------------------------------------------------------------------
+FText UCG_SpellComponentRegistry::GetComponentDescription(ESpellComponentType type) const
+{
+	return GetComponentRow(type).Description;
+}
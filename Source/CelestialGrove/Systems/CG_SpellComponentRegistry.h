@@ -0,0 +1,88 @@
+// ============================================================
+// FILE: CG_SpellComponentRegistry.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "Engine/StreamableManager.h"
+#include "CG_SpellTypes.h"
+#include "CG_SpellComponentRegistry.generated.h"
+
+class UDataTable;
+
+// ============================================================
+// Loads the spell component data table once and keeps a flat copy of the gameplay values indexed
+// by ESpellComponentType. Spells only ever refer to components by type, the full rows are only
+// handed out for the UI.
+//
+// It also owns the async loads of each component's soft assets (effect, sound and symbol). Handles
+// are only weakly held here, whoever requested them keeps them alive, so every spell using a
+// component shares one load and the assets are released with the last of them.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_SpellComponentRegistry : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	virtual void Initialize(FSubsystemCollectionBase & collection) override;
+	virtual void Deinitialize() override;
+
+	static UCG_SpellComponentRegistry * Get();
+
+	FORCEINLINE const FCG_SpellComponentStats & GetStats(ESpellComponentType type) const;
+	FORCEINLINE bool IsRegistered(ESpellComponentType type) const;
+
+	// Starts loading the component's assets if nothing else has. Returns null when the component
+	// has no assets to load.
+	TSharedPtr<FStreamableHandle> RequestComponentAssets(ESpellComponentType type);
+
+	UFUNCTION(BlueprintCallable)
+	const FCG_SpellComponent & GetComponentRow(ESpellComponentType type) const;
+
+	UFUNCTION(BlueprintCallable)
+	FText GetComponentPhonetic(ESpellComponentType type) const;
+
+	UFUNCTION(BlueprintCallable)
+	FText GetComponentDescription(ESpellComponentType type) const;
+
+protected:
+// ============================================================
+	UPROPERTY(Config)
+	TSoftObjectPtr<UDataTable> ComponentTable;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UDataTable> LoadedTable;
+
+private:
+// ============================================================
+	void BuildTables();
+
+// ============================================================
+	FCG_SpellComponentStats Stats[SPELL_COMPONENT_TYPE_COUNT];
+
+	// Points into LoadedTable, only used by the UI.
+	const FCG_SpellComponent * Rows[SPELL_COMPONENT_TYPE_COUNT];
+	uint16 RegisteredMask;
+
+	FStreamableManager StreamableManager;
+	TWeakPtr<FStreamableHandle> AssetHandles[SPELL_COMPONENT_TYPE_COUNT];
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE const FCG_SpellComponentStats & UCG_SpellComponentRegistry::GetStats(ESpellComponentType type) const
+{
+	checkSlow((int32)type < SPELL_COMPONENT_TYPE_COUNT);
+	return Stats[(int32)type];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool UCG_SpellComponentRegistry::IsRegistered(ESpellComponentType type) const
+{
+	return COMPARE_FLAG(RegisteredMask, (uint16)(1 << (int32)type));
+}
+// ============================================================
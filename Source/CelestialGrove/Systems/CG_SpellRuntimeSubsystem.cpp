@@ -0,0 +1,204 @@
+// ============================================================
+// FILE: CG_SpellRuntimeSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_SpellRuntimeSubsystem.h"
+#include "CG_SpellBase.h"
+#include "GameFramework/Actor.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spell Runtime Update"), STAT_SpellRuntimeUpdate, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spells"), STAT_NumSpells, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Spells"), STAT_NumActiveSpells, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellRuntimeSubsystem::Deinitialize()
+{
+	// Anything still alive outlives us, make sure they don't try to unregister later
+	for (UCG_SpellBase * spell : Spells)
+	{
+		spell->Runtime = nullptr;
+		spell->RuntimeId = INDEX_NONE;
+	}
+
+	Spells.Empty();
+	Casters.Empty();
+	Steps.Empty();
+	CooldownEndTimes.Empty();
+	PendingCooldowns.Empty();
+	CooldownTickets.Empty();
+	SpellIds.Empty();
+	IdToIndex.Empty();
+	FreeIds.Empty();
+	ActiveSpellIds.Empty();
+	CooldownQueue.Empty();
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellRuntimeSubsystem::Tick(float deltaTime)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_SpellRuntimeUpdate);
+	Super::Tick(deltaTime);
+
+	UpdateCooldowns();
+
+	// ============================================================
+	// Only spells that are actually being cast need to go back out to the spell object. Copy the
+	// list since finishing a spell takes it out of the active set.
+	TArray<int32, TInlineAllocator<32>> activeSpellIds(ActiveSpellIds);
+	for (int32 spellId : activeSpellIds)
+	{
+		const int32 index = IdToIndex[spellId];
+		if (index != INDEX_NONE && Steps[index] != ESpellComponentCategory::NONE)
+		{
+			Spells[index]->UpdateSpell(deltaTime, Casters[index].Get());
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_SpellRuntimeSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_SpellRuntimeSubsystem::IsTickable() const
+{
+	// An idle world with every spell off cooldown costs nothing
+	return IsInitialized() && (ActiveSpellIds.Num() > 0 || CooldownQueue.Num() > 0);
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_SpellRuntimeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_SpellRuntimeSubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+int32 UCG_SpellRuntimeSubsystem::RegisterSpell(UCG_SpellBase * spell)
+{
+	check(IsInGameThread());
+	check(spell);
+
+	int32 spellId = FreeIds.Num() > 0 ? FreeIds.Pop(false) : IdToIndex.Emplace(INDEX_NONE);
+
+	int32 index = Spells.Emplace(spell);
+	Casters.Emplace(nullptr);
+	Steps.Emplace(ESpellComponentCategory::NONE);
+	CooldownEndTimes.Emplace(0.0);
+	PendingCooldowns.Emplace(0.0f);
+	// NOTE(RyanC): Tickets start at 1 so a reused id can never match an entry still in the queue
+	CooldownTickets.Emplace(0);
+	SpellIds.Emplace(spellId);
+
+	IdToIndex[spellId] = index;
+	CG_SET_DWORD_STAT(STAT_NumSpells, Spells.Num());
+
+	return spellId;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellRuntimeSubsystem::UnregisterSpell(int32 spellId)
+{
+	check(IsInGameThread());
+
+	const int32 index = IdToIndex[spellId];
+	check(Spells.IsValidIndex(index));
+
+	if (Steps[index] != ESpellComponentCategory::NONE)
+	{
+		ActiveSpellIds.RemoveSingleSwap(spellId, false);
+	}
+
+	// Swap the last spell into the hole so the arrays stay packed
+	Spells.RemoveAtSwap(index, 1, false);
+	Casters.RemoveAtSwap(index, 1, false);
+	Steps.RemoveAtSwap(index, 1, false);
+	CooldownEndTimes.RemoveAtSwap(index, 1, false);
+	PendingCooldowns.RemoveAtSwap(index, 1, false);
+	CooldownTickets.RemoveAtSwap(index, 1, false);
+	SpellIds.RemoveAtSwap(index, 1, false);
+
+	if (SpellIds.IsValidIndex(index))
+	{
+		IdToIndex[SpellIds[index]] = index;
+	}
+
+	IdToIndex[spellId] = INDEX_NONE;
+	FreeIds.Emplace(spellId);
+
+	CG_SET_DWORD_STAT(STAT_NumSpells, Spells.Num());
+	CG_SET_DWORD_STAT(STAT_NumActiveSpells, ActiveSpellIds.Num());
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellRuntimeSubsystem::StartCasting(int32 spellId, const AActor * caster, float cooldown)
+{
+	const int32 index = IdToIndex[spellId];
+	Casters[index] = caster;
+
+	// NOTE(RyanC): The cooldown only starts counting once the spell has finished, until then the
+	// spell just counts as being on cooldown.
+	PendingCooldowns[index] = cooldown;
+	CooldownEndTimes[index] = CGCore::GetCastingEndTime(cooldown);
+	CooldownTickets[index] = 0;
+
+	SetStep(spellId, ESpellComponentCategory::TARGETING);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellRuntimeSubsystem::SetStep(int32 spellId, ESpellComponentCategory step)
+{
+	const int32 index = IdToIndex[spellId];
+	const ESpellComponentCategory previousStep = Steps[index];
+	Steps[index] = step;
+
+	if (previousStep == ESpellComponentCategory::NONE && step != ESpellComponentCategory::NONE)
+	{
+		ActiveSpellIds.Emplace(spellId);
+	}
+	else if (previousStep != ESpellComponentCategory::NONE && step == ESpellComponentCategory::NONE)
+	{
+		ActiveSpellIds.RemoveSingleSwap(spellId, false);
+
+		if (PendingCooldowns[index] > 0.0f)
+		{
+			CooldownEndTimes[index] = CGCore::GetCooldownEndTime(GetWorld()->GetTimeSeconds(), PendingCooldowns[index]);
+			CooldownTickets[index] = ++NextCooldownTicket;
+			PendingCooldowns[index] = 0.0f;
+
+			CooldownQueue.HeapPush({ CooldownEndTimes[index], spellId, CooldownTickets[index] });
+		}
+	}
+
+	CG_SET_DWORD_STAT(STAT_NumActiveSpells, ActiveSpellIds.Num());
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_SpellRuntimeSubsystem::UpdateCooldowns()
+{
+	const double now = GetWorld()->GetTimeSeconds();
+
+	while (CooldownQueue.Num() > 0 && CooldownQueue.HeapTop().EndTime <= now)
+	{
+		FCG_SpellCooldownEntry entry;
+		CooldownQueue.HeapPop(entry, false);
+
+		// Skip anything that was unregistered or recast since it was queued
+		const int32 index = IdToIndex.IsValidIndex(entry.SpellId) ? IdToIndex[entry.SpellId] : INDEX_NONE;
+		if (index == INDEX_NONE || CooldownTickets[index] != entry.Ticket)
+		{
+			continue;
+		}
+
+		UCG_SpellBase * spell = Spells[index];
+		if (spell->OnCooldownFinishedDelegate.IsBound())
+		{
+			spell->OnCooldownFinishedDelegate.Broadcast(spell);
+		}
+	}
+}
@@ -0,0 +1,115 @@
+// ============================================================
+// FILE: CG_SpellRuntimeSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Engine/World.h"
+#include "CG_SpellTypes.h"
+#include "CG_CooldownCore.h"
+#include "CG_SpellRuntimeSubsystem.generated.h"
+
+class AActor;
+class UCG_SpellBase;
+
+// ============================================================
+struct FCG_SpellCooldownEntry
+{
+	double EndTime;
+	int32 SpellId;
+	uint32 Ticket;
+
+	FORCEINLINE bool operator<(const FCG_SpellCooldownEntry & other) const
+	{
+		return EndTime < other.EndTime;
+	}
+};
+
+// ============================================================
+// Owns the runtime state of every live spell in the world (step, cooldown and caster) in packed
+// arrays. Nothing is updated per frame unless it has to be, spells are only woken up while they
+// are being cast or when their cooldown runs out.
+UCLASS()
+class CELESTIALGROVE_API UCG_SpellRuntimeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// Returns a stable id for the spell, it doesn't change when other spells are removed
+	int32 RegisterSpell(UCG_SpellBase * spell);
+	void UnregisterSpell(int32 spellId);
+
+	void SetStep(int32 spellId, ESpellComponentCategory step);
+	void StartCasting(int32 spellId, const AActor * caster, float cooldown);
+
+	FORCEINLINE ESpellComponentCategory GetStep(int32 spellId) const;
+	FORCEINLINE bool IsOnCooldown(int32 spellId) const;
+	FORCEINLINE float GetRemainingCooldown(int32 spellId) const;
+	FORCEINLINE int32 GetNumSpells() const;
+	FORCEINLINE int32 GetNumActiveSpells() const;
+
+private:
+// ============================================================
+	void UpdateCooldowns();
+
+// ============================================================
+	// NOTE(RyanC): Not uproperties, spells remove themselves in BeginDestroy so these never dangle.
+	TArray<UCG_SpellBase *> Spells;
+	TArray<TWeakObjectPtr<const AActor>> Casters;
+	TArray<ESpellComponentCategory> Steps;
+	TArray<double> CooldownEndTimes;
+	TArray<float> PendingCooldowns;
+	TArray<uint32> CooldownTickets;
+	TArray<int32> SpellIds;
+
+	// Stable id -> packed index
+	TArray<int32> IdToIndex;
+	TArray<int32> FreeIds;
+
+	// Spells currently in the targeting or effect step
+	TArray<int32> ActiveSpellIds;
+
+	// Min heap on end time, entries are skipped if their ticket no longer matches the spell's
+	TArray<FCG_SpellCooldownEntry> CooldownQueue;
+	uint32 NextCooldownTicket;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE ESpellComponentCategory UCG_SpellRuntimeSubsystem::GetStep(int32 spellId) const
+{
+	return Steps[IdToIndex[spellId]];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool UCG_SpellRuntimeSubsystem::IsOnCooldown(int32 spellId) const
+{
+	return CGCore::IsOnCooldown(CooldownEndTimes[IdToIndex[spellId]], GetWorld()->GetTimeSeconds());
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_SpellRuntimeSubsystem::GetRemainingCooldown(int32 spellId) const
+{
+	const int32 index = IdToIndex[spellId];
+	return CGCore::GetRemainingCooldown(CooldownEndTimes[index], PendingCooldowns[index], GetWorld()->GetTimeSeconds());
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_SpellRuntimeSubsystem::GetNumSpells() const
+{
+	return Spells.Num();
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_SpellRuntimeSubsystem::GetNumActiveSpells() const
+{
+	return ActiveSpellIds.Num();
+}
+// ============================================================
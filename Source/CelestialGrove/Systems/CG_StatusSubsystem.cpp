@@ -0,0 +1,238 @@
+// ============================================================
+// FILE: CG_StatusSubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_StatusSubsystem.h"
+#include "CG_Profiling.h"
+
+static_assert((uint8)ECombatStatuses::HELD == (1 << (int32)ETimedStatus::HELD), "Timed statuses have to line up with ECombatStatuses");
+static_assert((uint8)ECombatStatuses::ON_FIRE == (1 << (int32)ETimedStatus::ON_FIRE), "Timed statuses have to line up with ECombatStatuses");
+static_assert((uint8)ECombatStatuses::STUNNED == (1 << (int32)ETimedStatus::STUNNED), "Timed statuses have to line up with ECombatStatuses");
+
+DECLARE_CYCLE_STAT(TEXT("Status Pass"), STAT_StatusPass, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Statuses"), STAT_NumActiveStatuses, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+int32 FCG_StatusArray::Add(FCG_TargetHandle handle, float expiry)
+{
+	int32 index = Handles.Emplace(handle);
+	Expiries.Emplace(expiry);
+	Stacks.Emplace(1);
+	SlotToIndex.Add(handle.Slot, index);
+	return index;
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_StatusArray::RemoveAtSwap(int32 index)
+{
+	SlotToIndex.Remove(Handles[index].Slot);
+
+	const int32 last = Handles.Num() - 1;
+	if (index != last)
+	{
+		SlotToIndex[Handles[last].Slot] = index;
+	}
+
+	Handles.RemoveAtSwap(index, 1, false);
+	Expiries.RemoveAtSwap(index, 1, false);
+	Stacks.RemoveAtSwap(index, 1, false);
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_StatusArray::Empty()
+{
+	Handles.Empty();
+	Expiries.Empty();
+	Stacks.Empty();
+	SlotToIndex.Empty();
+}
+
+// -----------------------------------------------------------------------------------------
+UCG_StatusSubsystem::UCG_StatusSubsystem()
+{
+	TickInterval = 1.0f;
+	HeldDuration = 3.0f;
+	BurnDuration = 4.0f;
+	StunDuration = 2.0f;
+	BurnDamage = 1;
+	MaxBurnStacks = 3;
+
+	Registry = nullptr;
+	CombatState = nullptr;
+	TimeUntilPass = 0.0f;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_StatusSubsystem::Initialize(FSubsystemCollectionBase & collection)
+{
+	Super::Initialize(collection);
+
+	Registry = collection.InitializeDependency<UCG_TargetRegistrySubsystem>();
+	check(Registry);
+
+	CombatState = collection.InitializeDependency<UCG_CombatStateSubsystem>();
+	check(CombatState);
+
+	TimeUntilPass = TickInterval;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_StatusSubsystem::Deinitialize()
+{
+	for (FCG_StatusArray & statuses : Statuses)
+	{
+		statuses.Empty();
+	}
+
+	PendingDamage.Empty();
+	Registry = nullptr;
+	CombatState = nullptr;
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_StatusSubsystem::Tick(float deltaTime)
+{
+	Super::Tick(deltaTime);
+
+	TimeUntilPass -= deltaTime;
+	if (TimeUntilPass > 0.0f)
+	{
+		return;
+	}
+
+	// NOTE(RyanC): One pass however long the hitch was, otherwise a stall would land several ticks
+	// of burn damage in the same frame.
+	TimeUntilPass = FMath::Max(TimeUntilPass + TickInterval, 0.0f);
+	ProcessStatuses(GetWorld()->GetTimeSeconds());
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_StatusSubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_StatusSubsystem::IsTickable() const
+{
+	if (!IsInitialized())
+	{
+		return false;
+	}
+
+	for (const FCG_StatusArray & statuses : Statuses)
+	{
+		if (statuses.Handles.Num() > 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_StatusSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_StatusSubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_StatusSubsystem::ApplyStatus(FCG_TargetHandle handle, uint8 status)
+{
+	check(IsInGameThread());
+
+	if (!Registry->GetTarget(handle))
+	{
+		return;
+	}
+
+	// Untimed bits like DEATH only ever live in the mask
+	CombatState->SetStatusFlags(handle, status);
+
+	const float now = GetWorld()->GetTimeSeconds();
+	for (int32 i = 0; i < TIMED_STATUS_COUNT; ++i)
+	{
+		const ETimedStatus timed = (ETimedStatus)i;
+		if (!COMPARE_FLAG(status, GetStatusFlag(timed)))
+		{
+			continue;
+		}
+
+		FCG_StatusArray & statuses = Statuses[i];
+		const float expiry = now + GetDuration(timed);
+
+		const int32 * existing = statuses.SlotToIndex.Find(handle.Slot);
+		if (!existing)
+		{
+			statuses.Add(handle, expiry);
+			continue;
+		}
+
+		// Same slot but an older generation is whoever had it before, just take the entry over
+		if (statuses.Handles[*existing] == handle)
+		{
+			if (timed == ETimedStatus::ON_FIRE)
+			{
+				statuses.Stacks[*existing] = (uint8)FMath::Min((int32)statuses.Stacks[*existing] + 1, MaxBurnStacks);
+			}
+		}
+		else
+		{
+			statuses.Handles[*existing] = handle;
+			statuses.Stacks[*existing] = 1;
+		}
+
+		statuses.Expiries[*existing] = expiry;
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_StatusSubsystem::ProcessStatuses(float now)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_StatusPass);
+
+	int32 numActive = 0;
+	PendingDamage.Reset();
+
+	for (int32 s = 0; s < TIMED_STATUS_COUNT; ++s)
+	{
+		FCG_StatusArray & statuses = Statuses[s];
+		const uint8 flag = GetStatusFlag((ETimedStatus)s);
+		const bool burns = ((ETimedStatus)s == ETimedStatus::ON_FIRE);
+
+		for (int32 i = statuses.Handles.Num() - 1; i >= 0; --i)
+		{
+			// NOTE(RyanC): A stale handle means the owner unregistered, its combat state went with it so
+			// there are no status flags left to clear.
+			if (!Registry->GetTarget(statuses.Handles[i]))
+			{
+				statuses.RemoveAtSwap(i);
+				continue;
+			}
+
+			if (statuses.Expiries[i] <= now)
+			{
+				const FCG_TargetHandle expired = statuses.Handles[i];
+				statuses.RemoveAtSwap(i);
+				CombatState->ClearStatusFlags(expired, flag);
+				continue;
+			}
+
+			if (burns)
+			{
+				PendingDamage.Add({ statuses.Handles[i], BurnDamage * statuses.Stacks[i] });
+			}
+		}
+
+		numActive += statuses.Handles.Num();
+	}
+
+	// Handles are checked again on the way in, the owners only hear about it once the batch is done
+	CombatState->ApplyDamage(PendingDamage);
+
+	CG_SET_DWORD_STAT(STAT_NumActiveStatuses, numActive);
+}
@@ -0,0 +1,139 @@
+// ============================================================
+// FILE: CG_StatusSubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CG_GlobalDefines.h"
+#include "CG_TargetRegistrySubsystem.h"
+#include "CG_CombatStateSubsystem.h"
+#include "CG_StatusSubsystem.generated.h"
+
+// ============================================================
+// Statuses that wear off, DEATH is just a flag and never goes through here
+enum class ETimedStatus : uint8
+{
+	HELD = 0,
+	ON_FIRE,
+	STUNNED
+};
+
+#define TIMED_STATUS_COUNT 3
+
+// ============================================================
+// Everything carrying one status, structure of arrays so a pass only touches what it reads
+struct FCG_StatusArray
+{
+public:
+// ============================================================
+	int32 Add(FCG_TargetHandle handle, float expiry);
+	void RemoveAtSwap(int32 index);
+	void Empty();
+
+// ============================================================
+	// Packed, swap removed
+	TArray<FCG_TargetHandle> Handles;
+	TArray<float> Expiries;
+	TArray<uint8> Stacks;
+
+	// Target registry slot -> index
+	TMap<int32, int32> SlotToIndex;
+};
+
+// ============================================================
+// Timed statuses for every spell target in the world. Durations, stacks and damage over time are
+// all handled in one batched pass every TickInterval, the status bits themselves live in the combat
+// state subsystem and are set and cleared through it.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_StatusSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_StatusSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase & collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// status is an ECombatStatuses mask, reapplying refreshes the duration
+	void ApplyStatus(FCG_TargetHandle target, uint8 status);
+
+	FORCEINLINE int32 GetNumWithStatus(ETimedStatus status) const;
+
+protected:
+// ============================================================
+	// How often the batched pass runs, damage over time lands once per pass
+	UPROPERTY(Config)
+	float TickInterval;
+
+	UPROPERTY(Config)
+	float HeldDuration;
+
+	UPROPERTY(Config)
+	float BurnDuration;
+
+	UPROPERTY(Config)
+	float StunDuration;
+
+	// Per stack, per pass
+	UPROPERTY(Config)
+	int32 BurnDamage;
+
+	UPROPERTY(Config)
+	int32 MaxBurnStacks;
+
+private:
+// ============================================================
+	void ProcessStatuses(float now);
+	FORCEINLINE float GetDuration(ETimedStatus status) const;
+	FORCEINLINE static uint8 GetStatusFlag(ETimedStatus status);
+
+// ============================================================
+	FCG_StatusArray Statuses[TIMED_STATUS_COUNT];
+
+	// Damage gathered during a pass and applied as one batch after it, applying it can kill a
+	// target and unregister it while the arrays are still being walked.
+	TArray<FCG_CombatDamage> PendingDamage;
+
+	UCG_TargetRegistrySubsystem * Registry;
+	UCG_CombatStateSubsystem * CombatState;
+	float TimeUntilPass;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_StatusSubsystem::GetNumWithStatus(ETimedStatus status) const
+{
+	return Statuses[(int32)status].Handles.Num();
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE float UCG_StatusSubsystem::GetDuration(ETimedStatus status) const
+{
+	switch (status)
+	{
+		case ETimedStatus::HELD:
+			return HeldDuration;
+
+		case ETimedStatus::ON_FIRE:
+			return BurnDuration;
+
+		default:
+			return StunDuration;
+	}
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE uint8 UCG_StatusSubsystem::GetStatusFlag(ETimedStatus status)
+{
+	// NOTE(RyanC): Timed statuses are the low bits of ECombatStatuses in the same order
+	return (uint8)(1 << (int32)status);
+}
+// ============================================================
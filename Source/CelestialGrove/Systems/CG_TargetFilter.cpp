@@ -0,0 +1,230 @@
+// ============================================================
+// FILE: CG_TargetFilter.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_TargetFilter.h"
+#include "CG_GlobalDefines.h"
+#include "Math/VectorRegister.h"
+#include "HAL/IConsoleManager.h"
+
+// Padding candidates sit out here so they always fail the distance test
+#define TARGET_FILTER_PAD_LOCATION 1.0e18f
+#define TARGET_FILTER_MIN_DIST_SQ 1.0e-8f
+
+// -----------------------------------------------------------------------------------------
+void FCG_TargetCandidates::Reset()
+{
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+	Radius.Reset();
+	Index.Reset();
+	DirX.Reset();
+	DirY.Reset();
+	DirZ.Reset();
+	Falloff.Reset();
+	Num = 0;
+}
+
+// -----------------------------------------------------------------------------------------
+void FCG_TargetCandidates::Pad()
+{
+	const int32 padded = Align(Num, TARGET_FILTER_WIDTH);
+	while (X.Num() < padded)
+	{
+		X.Emplace(TARGET_FILTER_PAD_LOCATION);
+		Y.Emplace(TARGET_FILTER_PAD_LOCATION);
+		Z.Emplace(TARGET_FILTER_PAD_LOCATION);
+		Radius.Emplace(0.0f);
+		Index.Emplace(INDEX_NONE);
+	}
+
+	DirX.SetNumUninitialized(padded, false);
+	DirY.SetNumUninitialized(padded, false);
+	DirZ.SetNumUninitialized(padded, false);
+	Falloff.SetNumUninitialized(padded, false);
+}
+
+// -----------------------------------------------------------------------------------------
+int32 FilterTargetCandidates(const FCG_TargetFilterQuery & query, FCG_TargetCandidates & candidates)
+{
+	checkSlow(candidates.X.Num() % TARGET_FILTER_WIDTH == 0);
+
+	const VectorRegister4Float originX = VectorSetFloat1(query.Origin.X);
+	const VectorRegister4Float originY = VectorSetFloat1(query.Origin.Y);
+	const VectorRegister4Float originZ = VectorSetFloat1(query.Origin.Z);
+	const VectorRegister4Float forwardX = VectorSetFloat1(query.Forward.X);
+	const VectorRegister4Float forwardY = VectorSetFloat1(query.Forward.Y);
+	const VectorRegister4Float forwardZ = VectorSetFloat1(query.Forward.Z);
+	const VectorRegister4Float radius = VectorSetFloat1(query.Radius);
+	const VectorRegister4Float cosAngle = VectorSetFloat1(query.CosAngle);
+	const VectorRegister4Float minDistSq = VectorSetFloat1(TARGET_FILTER_MIN_DIST_SQ);
+	const VectorRegister4Float zero = VectorZeroFloat();
+	const VectorRegister4Float one = VectorOneFloat();
+	const bool isCone = query.CosAngle > -1.0f;
+
+	float * x = candidates.X.GetData();
+	float * y = candidates.Y.GetData();
+	float * z = candidates.Z.GetData();
+	float * r = candidates.Radius.GetData();
+	int32 * index = candidates.Index.GetData();
+	float * dirX = candidates.DirX.GetData();
+	float * dirY = candidates.DirY.GetData();
+	float * dirZ = candidates.DirZ.GetData();
+	float * falloff = candidates.Falloff.GetData();
+
+	int32 kept = 0;
+	const int32 padded = candidates.X.Num();
+	for (int32 i = 0; i < padded; i += TARGET_FILTER_WIDTH)
+	{
+		VectorRegister4Float dx = VectorSubtract(VectorLoad(x + i), originX);
+		VectorRegister4Float dy = VectorSubtract(VectorLoad(y + i), originY);
+		VectorRegister4Float dz = VectorSubtract(VectorLoad(z + i), originZ);
+
+		VectorRegister4Float distSq = VectorMultiplyAdd(dz, dz, VectorMultiplyAdd(dy, dy, VectorMultiply(dx, dx)));
+		VectorRegister4Float reach = VectorAdd(VectorLoad(r + i), radius);
+		VectorRegister4Float mask = VectorCompareLE(distSq, VectorMultiply(reach, reach));
+
+		// Anything sitting right on the origin gets a zero direction instead of a nan
+		VectorRegister4Float invDist = VectorReciprocalSqrt(VectorMax(distSq, minDistSq));
+		VectorRegister4Float nx = VectorMultiply(dx, invDist);
+		VectorRegister4Float ny = VectorMultiply(dy, invDist);
+		VectorRegister4Float nz = VectorMultiply(dz, invDist);
+
+		if (isCone)
+		{
+			// NOTE(RyanC): Comparing against the cosine skips the acos the old cone check did per target.
+			VectorRegister4Float dot = VectorMultiplyAdd(nz, forwardZ, VectorMultiplyAdd(ny, forwardY, VectorMultiply(nx, forwardX)));
+			mask = VectorBitwiseAnd(mask, VectorCompareGE(dot, cosAngle));
+		}
+
+		uint32 bits = (uint32)VectorMaskBits(mask);
+		if (bits == 0)
+		{
+			continue;
+		}
+
+		VectorRegister4Float dist = VectorMultiply(distSq, invDist);
+		VectorRegister4Float fall = VectorMin(VectorMax(VectorSubtract(one, VectorDivide(dist, reach)), zero), one);
+
+		// Written to the candidate's own slot first, compaction below only ever moves things forward
+		VectorStore(nx, dirX + i);
+		VectorStore(ny, dirY + i);
+		VectorStore(nz, dirZ + i);
+		VectorStore(fall, falloff + i);
+
+		for (int32 lane = 0; lane < TARGET_FILTER_WIDTH; ++lane)
+		{
+			if ((bits & (1 << lane)) == 0)
+			{
+				continue;
+			}
+
+			const int32 from = i + lane;
+			x[kept] = x[from];
+			y[kept] = y[from];
+			z[kept] = z[from];
+			r[kept] = r[from];
+			index[kept] = index[from];
+			dirX[kept] = dirX[from];
+			dirY[kept] = dirY[from];
+			dirZ[kept] = dirZ[from];
+			falloff[kept] = falloff[from];
+			++kept;
+		}
+	}
+
+	candidates.Num = kept;
+	return kept;
+}
+
+#if !UE_BUILD_SHIPPING
+// ============================================================
+// Benchmark, runs the filter against the per target acos loop it replaced
+// -----------------------------------------------------------------------------------------
+internal int32 FilterTargetCandidatesScalar(const FCG_TargetFilterQuery & query, const TArray<FVector3f> & locations, const TArray<float> & radii, TArray<int32> & kept)
+{
+	const float angle = FMath::Acos(query.CosAngle);
+
+	kept.Reset();
+	for (int32 i = 0; i < locations.Num(); ++i)
+	{
+		FVector3f toTarget = locations[i] - query.Origin;
+		float reach = query.Radius + radii[i];
+		if (toTarget.SizeSquared() > reach * reach)
+		{
+			continue;
+		}
+
+		float dot = FVector3f::DotProduct(toTarget.GetSafeNormal(), query.Forward);
+		if (FMath::Acos(dot) > angle)
+		{
+			continue;
+		}
+
+		kept.Emplace(i);
+	}
+
+	return kept.Num();
+}
+
+// -----------------------------------------------------------------------------------------
+internal void BenchmarkTargetFilter(const TArray<FString> & args)
+{
+	const int32 numCandidates = args.Num() > 0 ? FCString::Atoi(*args[0]) : 10000;
+	const int32 iterations = args.Num() > 1 ? FCString::Atoi(*args[1]) : 100;
+
+	FRandomStream random(1337);
+	TArray<FVector3f> locations;
+	TArray<float> radii;
+	for (int32 i = 0; i < numCandidates; ++i)
+	{
+		locations.Emplace(random.FRandRange(-5000.0f, 5000.0f), random.FRandRange(-5000.0f, 5000.0f), random.FRandRange(-200.0f, 200.0f));
+		radii.Emplace(random.FRandRange(20.0f, 100.0f));
+	}
+
+	FCG_TargetFilterQuery query;
+	query.Origin = FVector3f::ZeroVector;
+	query.Forward = FVector3f(1.0f, 0.0f, 0.0f);
+	query.Radius = 2500.0f;
+	query.CosAngle = FMath::Cos(FMath::DegreesToRadians(30.0f));
+
+	FCG_TargetCandidates candidates;
+	int32 simdKept = 0;
+	double simdSeconds = 0.0;
+	for (int32 i = 0; i < iterations; ++i)
+	{
+		// Refilling is part of what a real query pays for
+		double start = FPlatformTime::Seconds();
+		candidates.Reset();
+		for (int32 c = 0; c < numCandidates; ++c)
+		{
+			candidates.Add(FVector(locations[c]), radii[c], c);
+		}
+		candidates.Pad();
+		simdKept = FilterTargetCandidates(query, candidates);
+		simdSeconds += FPlatformTime::Seconds() - start;
+	}
+
+	TArray<int32> scalarIndices;
+	int32 scalarKept = 0;
+	double scalarSeconds = 0.0;
+	for (int32 i = 0; i < iterations; ++i)
+	{
+		double start = FPlatformTime::Seconds();
+		scalarKept = FilterTargetCandidatesScalar(query, locations, radii, scalarIndices);
+		scalarSeconds += FPlatformTime::Seconds() - start;
+	}
+
+	UE_LOG(LogCelestialGrove, Display, TEXT("Target filter, %d candidates x %d: simd %.2f us (%d kept), scalar %.2f us (%d kept)"),
+		numCandidates, iterations,
+		(simdSeconds / iterations) * 1.0e6, simdKept,
+		(scalarSeconds / iterations) * 1.0e6, scalarKept);
+}
+
+global FAutoConsoleCommand GBenchmarkTargetFilterCommand(
+	TEXT("CG.BenchmarkTargetFilter"),
+	TEXT("Times the spell target filter. Args: [numCandidates=10000] [iterations=100]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkTargetFilter));
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,70 @@
+// ============================================================
+// FILE: CG_TargetFilter.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Candidates are filtered this many at a time
+#define TARGET_FILTER_WIDTH 4
+
+// ============================================================
+// Structure of arrays so the filter can load four candidates straight into a register. The
+// arrays are always padded out to a multiple of TARGET_FILTER_WIDTH, Num is the real count.
+struct CELESTIALGROVE_API FCG_TargetCandidates
+{
+public:
+// ============================================================
+	void Reset();
+	FORCEINLINE void Add(const FVector & location, float radius, int32 index);
+
+	// Has to be called before filtering, pads the arrays with candidates that can't pass
+	void Pad();
+
+// ============================================================
+	TArray<float> X;
+	TArray<float> Y;
+	TArray<float> Z;
+	TArray<float> Radius;
+	TArray<int32> Index;
+
+	// Only filled in for candidates that pass
+	TArray<float> DirX;
+	TArray<float> DirY;
+	TArray<float> DirZ;
+	TArray<float> Falloff;
+
+	int32 Num = 0;
+};
+
+// ============================================================
+struct FCG_TargetFilterQuery
+{
+	FVector3f Origin;
+	FVector3f Forward;
+	float Radius;
+
+	// Cosine of the cone's half angle, anything at or below -1 makes it a plain sphere
+	float CosAngle;
+};
+
+// Keeps the candidates whose bounds touch the sphere (and fall inside the cone), compacted to the
+// front of the arrays in their original order. Fills in the normalized direction from the origin
+// and a 1 -> 0 falloff over the reach for each of them. Returns how many are left.
+CELESTIALGROVE_API int32 FilterTargetCandidates(const FCG_TargetFilterQuery & query, FCG_TargetCandidates & candidates);
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE void FCG_TargetCandidates::Add(const FVector & location, float radius, int32 index)
+{
+	X.Emplace((float)location.X);
+	Y.Emplace((float)location.Y);
+	Z.Emplace((float)location.Z);
+	Radius.Emplace(radius);
+	Index.Emplace(index);
+	++Num;
+}
+// ============================================================
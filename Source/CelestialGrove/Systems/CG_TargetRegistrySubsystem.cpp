@@ -0,0 +1,436 @@
+// ============================================================
+// FILE: CG_TargetRegistrySubsystem.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_TargetRegistrySubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/Actor.h"
+#include "CG_Profiling.h"
+
+DECLARE_CYCLE_STAT(TEXT("Target Registry Update"), STAT_TargetRegistryUpdate, STATGROUP_CelestialGrove);
+DECLARE_CYCLE_STAT(TEXT("Target Registry Query"), STAT_TargetRegistryQuery, STATGROUP_CelestialGrove);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spell Targets"), STAT_NumSpellTargets, STATGROUP_CelestialGrove);
+
+// -----------------------------------------------------------------------------------------
+// Box around everything within radius of origin and angle of forward, forward has to be normalized.
+internal void GetConeBounds(const FVector & origin, const FVector & forward, float radius, float angle, FVector & boundsMin, FVector & boundsMax)
+{
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		// NOTE(RyanC): The furthest the cone reaches along an axis is the direction inside it closest
+		// to that axis, all the way if the axis is inside the cone. The apex keeps the origin in the box.
+		const float toPositive = FMath::Acos(FMath::Clamp((float)forward[axis], -1.0f, 1.0f));
+		const float toNegative = PI - toPositive;
+		const float reachPositive = (toPositive <= angle) ? radius : radius * FMath::Max(FMath::Cos(toPositive - angle), 0.0f);
+		const float reachNegative = (toNegative <= angle) ? radius : radius * FMath::Max(FMath::Cos(toNegative - angle), 0.0f);
+
+		boundsMin[axis] = origin[axis] - reachNegative;
+		boundsMax[axis] = origin[axis] + reachPositive;
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+UCG_TargetRegistrySubsystem::UCG_TargetRegistrySubsystem()
+{
+	CellSize = 500.0f;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::Deinitialize()
+{
+	for (int32 i = 0; i < Bodies.Num(); ++i)
+	{
+		UPrimitiveComponent * body = Bodies[i].Get();
+		if (body)
+		{
+			body->TransformUpdated.Remove(MovedHandles[i]);
+		}
+	}
+
+	Actors.Empty();
+	Targets.Empty();
+	Bodies.Empty();
+	LocationsX.Empty();
+	LocationsY.Empty();
+	LocationsZ.Empty();
+	Radii.Empty();
+	Candidates.Reset();
+	Cells.Empty();
+	Kinds.Empty();
+	MovedHandles.Empty();
+	IndexToSlot.Empty();
+	SlotToIndex.Empty();
+	SlotGenerations.Empty();
+	FreeSlots.Empty();
+	MovedSlots.Empty();
+	HasSlotMoved.Empty();
+	ActorToIndex.Empty();
+
+	for (TMap<FIntVector, TArray<int32>> & grid : Grids)
+	{
+		grid.Empty();
+	}
+
+	Super::Deinitialize();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::Tick(float deltaTime)
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetRegistryUpdate);
+	Super::Tick(deltaTime);
+
+	// NOTE(RyanC): Only bodies that moved since last tick get their bounds read, and only the ones
+	// that crossed into another cell touch the grid.
+	for (int32 slot : MovedSlots)
+	{
+		HasSlotMoved[slot] = false;
+
+		// The target could have unregistered since it moved
+		const int32 index = SlotToIndex[slot];
+		const UPrimitiveComponent * body = (index != INDEX_NONE) ? Bodies[index].Get() : nullptr;
+		if (!body)
+		{
+			continue;
+		}
+
+		const FBoxSphereBounds & bounds = body->Bounds;
+		LocationsX[index] = bounds.Origin.X;
+		LocationsY[index] = bounds.Origin.Y;
+		LocationsZ[index] = bounds.Origin.Z;
+		Radii[index] = bounds.SphereRadius;
+
+		SetCell(index, GetTargetCell(bounds.Origin, bounds.SphereRadius));
+	}
+
+	MovedSlots.Reset();
+
+	CG_SET_DWORD_STAT(STAT_NumSpellTargets, Actors.Num());
+}
+
+// -----------------------------------------------------------------------------------------
+ETickableTickType UCG_TargetRegistrySubsystem::GetTickableTickType() const
+{
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_TargetRegistrySubsystem::IsTickable() const
+{
+	return IsInitialized() && MovedSlots.Num() > 0;
+}
+
+// -----------------------------------------------------------------------------------------
+TStatId UCG_TargetRegistrySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCG_TargetRegistrySubsystem, STATGROUP_Tickables);
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_TargetHandle UCG_TargetRegistrySubsystem::RegisterTarget(AActor * actor, const FCG_SpellTarget * target, ESpellTargetKind kind, UPrimitiveComponent * body)
+{
+	check(IsInGameThread());
+	check(actor && target && body);
+
+	if (ActorToIndex.Contains(actor))
+	{
+		UnregisterTarget(actor);
+	}
+
+	const FBoxSphereBounds & bounds = body->Bounds;
+
+	int32 index = Actors.Emplace(actor);
+	Targets.Emplace(target);
+	Bodies.Emplace(body);
+	LocationsX.Emplace(bounds.Origin.X);
+	LocationsY.Emplace(bounds.Origin.Y);
+	LocationsZ.Emplace(bounds.Origin.Z);
+	Radii.Emplace(bounds.SphereRadius);
+	Cells.Emplace(GetTargetCell(bounds.Origin, bounds.SphereRadius));
+	Kinds.Emplace(kind);
+
+	int32 slot = FreeSlots.Num() > 0 ? FreeSlots.Pop(false) : SlotToIndex.Emplace(INDEX_NONE);
+	if (!SlotGenerations.IsValidIndex(slot))
+	{
+		SlotGenerations.Emplace(1);
+		HasSlotMoved.Emplace(false);
+	}
+	SlotToIndex[slot] = index;
+	IndexToSlot.Emplace(slot);
+
+	// NOTE(RyanC): Fires for everything that moves the body, movement, physics and parents moving
+	// alike, so the registry never has to poll bodies that are standing still.
+	MovedHandles.Emplace(body->TransformUpdated.AddUObject(this, &UCG_TargetRegistrySubsystem::OnBodyMoved, slot));
+
+	ActorToIndex.Add(actor, index);
+	Grids[(int32)kind].FindOrAdd(Cells[index]).Emplace(index);
+	CG_SET_DWORD_STAT(STAT_NumSpellTargets, Actors.Num());
+
+	return MakeHandle(index);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::UnregisterTarget(AActor * actor)
+{
+	check(IsInGameThread());
+
+	int32 index;
+	if (!ActorToIndex.RemoveAndCopyValue(actor, index))
+	{
+		return;
+	}
+
+	TMap<FIntVector, TArray<int32>> & grid = Grids[(int32)Kinds[index]];
+	TArray<int32> & cell = grid.FindChecked(Cells[index]);
+	cell.RemoveSingleSwap(index, false);
+	if (cell.Num() == 0)
+	{
+		grid.Remove(Cells[index]);
+	}
+
+	UPrimitiveComponent * body = Bodies[index].Get();
+	if (body)
+	{
+		body->TransformUpdated.Remove(MovedHandles[index]);
+	}
+
+	// The last target is about to be swapped into index, point its cell and lookup at the new slot
+	const int32 last = Actors.Num() - 1;
+	if (index != last)
+	{
+		TArray<int32> & lastCell = Grids[(int32)Kinds[last]].FindChecked(Cells[last]);
+		lastCell[lastCell.IndexOfByKey(last)] = index;
+
+		// NOTE(RyanC): The actor could already be pending kill here, the lookup is keyed on the raw pointer anyway.
+		ActorToIndex[Actors[last].GetEvenIfUnreachable()] = index;
+		SlotToIndex[IndexToSlot[last]] = index;
+	}
+
+	// Anything still holding a handle to this slot stops resolving
+	const int32 slot = IndexToSlot[index];
+	SlotToIndex[slot] = INDEX_NONE;
+	++SlotGenerations[slot];
+	if (SlotGenerations[slot] == 0)
+	{
+		SlotGenerations[slot] = 1;
+	}
+	FreeSlots.Emplace(slot);
+
+	Actors.RemoveAtSwap(index, 1, false);
+	Targets.RemoveAtSwap(index, 1, false);
+	Bodies.RemoveAtSwap(index, 1, false);
+	LocationsX.RemoveAtSwap(index, 1, false);
+	LocationsY.RemoveAtSwap(index, 1, false);
+	LocationsZ.RemoveAtSwap(index, 1, false);
+	Radii.RemoveAtSwap(index, 1, false);
+	Cells.RemoveAtSwap(index, 1, false);
+	Kinds.RemoveAtSwap(index, 1, false);
+	MovedHandles.RemoveAtSwap(index, 1, false);
+	IndexToSlot.RemoveAtSwap(index, 1, false);
+
+	CG_SET_DWORD_STAT(STAT_NumSpellTargets, Actors.Num());
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::OnBodyMoved(USceneComponent * component, EUpdateTransformFlags flags, ETeleportType teleport, int32 slot)
+{
+	if (!HasSlotMoved[slot])
+	{
+		HasSlotMoved[slot] = true;
+		MovedSlots.Emplace(slot);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::SetCell(int32 index, const FIntVector & cell)
+{
+	if (cell == Cells[index])
+	{
+		return;
+	}
+
+	TMap<FIntVector, TArray<int32>> & grid = Grids[(int32)Kinds[index]];
+
+	TArray<int32> & oldCell = grid.FindChecked(Cells[index]);
+	oldCell.RemoveSingleSwap(index, false);
+	if (oldCell.Num() == 0)
+	{
+		grid.Remove(Cells[index]);
+	}
+
+	grid.FindOrAdd(cell).Emplace(index);
+	Cells[index] = cell;
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::AddCandidates(const TArray<int32> * cell, int32 ignoredIndex) const
+{
+	if (!cell)
+	{
+		return;
+	}
+
+	for (int32 index : *cell)
+	{
+		if (index != ignoredIndex)
+		{
+			Candidates.Add(GetLocation(index), Radii[index], index);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::GetTargetsInSphere(ESpellCollisionType type, const FVector & origin, float radius, const AActor * ignoredActor, TArray<FCG_TargetHit> & hits) const
+{
+	GetTargetsInCone(type, origin, FVector::ForwardVector, radius, PI, ignoredActor, hits);
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::GetTargetsInCone(ESpellCollisionType type, const FVector & origin, const FVector & forward, float radius, float angle, const AActor * ignoredActor, TArray<FCG_TargetHit> & hits) const
+{
+	CG_SCOPE_CYCLE_COUNTER(STAT_TargetRegistryQuery);
+	check(IsInGameThread());
+
+	Candidates.Reset();
+
+	// Resolved once up front so the gather loop is just an int compare
+	const int32 * ignored = ignoredActor ? ActorToIndex.Find(ignoredActor) : nullptr;
+	const int32 ignoredIndex = ignored ? *ignored : INDEX_NONE;
+
+	const FVector direction = forward.GetSafeNormal();
+	const float queryAngle = direction.IsZero() ? PI : angle;
+
+	// Loose cells, anything binned outside these is too far away for its bounds to reach the query
+	FVector boundsMin;
+	FVector boundsMax;
+	GetConeBounds(origin, direction, radius, queryAngle, boundsMin, boundsMax);
+
+	const FVector looseness(CellSize * TARGET_CELL_LOOSENESS);
+	const FIntVector minCell = GetCell(boundsMin - looseness);
+	const FIntVector maxCell = GetCell(boundsMax + looseness);
+	const int64 numCellsInRange = (int64)(maxCell.X - minCell.X + 1) * (maxCell.Y - minCell.Y + 1) * (maxCell.Z - minCell.Z + 1);
+
+	for (int32 kind = 0; kind < SPELL_TARGET_KIND_COUNT; ++kind)
+	{
+		if (!AllowsKind(type, (ESpellTargetKind)kind))
+		{
+			continue;
+		}
+
+		const TMap<FIntVector, TArray<int32>> & grid = Grids[kind];
+
+		// NOTE(RyanC): Big queries over a sparse grid would mostly be looking up empty cells, walk
+		// the occupied ones instead once there are fewer of them than cells in range.
+		if (numCellsInRange > grid.Num())
+		{
+			for (const TPair<FIntVector, TArray<int32>> & cell : grid)
+			{
+				const FIntVector & key = cell.Key;
+				if (key != LARGE_TARGET_CELL &&
+					key.X >= minCell.X && key.X <= maxCell.X &&
+					key.Y >= minCell.Y && key.Y <= maxCell.Y &&
+					key.Z >= minCell.Z && key.Z <= maxCell.Z)
+				{
+					AddCandidates(&cell.Value, ignoredIndex);
+				}
+			}
+		}
+		else
+		{
+			for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+			{
+				for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+				{
+					for (int32 x = minCell.X; x <= maxCell.X; ++x)
+					{
+						AddCandidates(grid.Find(FIntVector(x, y, z)), ignoredIndex);
+					}
+				}
+			}
+		}
+
+		AddCandidates(grid.Find(LARGE_TARGET_CELL), ignoredIndex);
+	}
+
+	if (Candidates.Num == 0)
+	{
+		return;
+	}
+
+	// Same as the physics overlap, touching the target's bounds is enough
+	FCG_TargetFilterQuery query;
+	query.Origin = FVector3f(origin);
+	query.Forward = FVector3f(direction);
+	query.Radius = radius;
+	query.CosAngle = (queryAngle >= PI) ? -2.0f : FMath::Cos(queryAngle);
+
+	Candidates.Pad();
+	const int32 numKept = FilterTargetCandidates(query, Candidates);
+
+	hits.Reserve(hits.Num() + numKept);
+	for (int32 i = 0; i < numKept; ++i)
+	{
+		const int32 index = Candidates.Index[i];
+
+		FCG_TargetHit & hit = hits.AddDefaulted_GetRef();
+		hit.Handle = MakeHandle(index);
+		hit.ImpactDirection = FVector(Candidates.DirX[i], Candidates.DirY[i], Candidates.DirZ[i]);
+		hit.DistanceFalloff = Candidates.Falloff[i];
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+bool UCG_TargetRegistrySubsystem::FindTarget(const AActor * actor, ESpellCollisionType type, const FVector & origin, FCG_TargetHit & hit) const
+{
+	const int32 * index = ActorToIndex.Find(actor);
+	if (!index || !AllowsKind(type, Kinds[*index]))
+	{
+		return false;
+	}
+
+	const UPrimitiveComponent * body = Bodies[*index].Get();
+	FVector center = body ? body->GetCenterOfMass() : GetLocation(*index);
+
+	hit.Handle = MakeHandle(*index);
+	hit.ImpactDirection = (center - origin).GetSafeNormal();
+	hit.DistanceFalloff = 1.0f;
+	return true;
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_TargetHandle UCG_TargetRegistrySubsystem::FindHandle(const AActor * actor) const
+{
+	const int32 * index = ActorToIndex.Find(actor);
+	return index ? MakeHandle(*index) : FCG_TargetHandle();
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::ApplyDamage(FCG_TargetHandle handle, int32 damage) const
+{
+	const FCG_SpellTarget * target = GetTarget(handle);
+	if (target)
+	{
+		target->ApplyDamageDelegate.Broadcast(damage);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::ApplyStatus(FCG_TargetHandle handle, uint8 status) const
+{
+	const FCG_SpellTarget * target = GetTarget(handle);
+	if (target)
+	{
+		target->ApplyStatusDelegate.Broadcast(status);
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+void UCG_TargetRegistrySubsystem::ApplyForce(FCG_TargetHandle handle, const FVector & direction, float strength) const
+{
+	const FCG_SpellTarget * target = GetTarget(handle);
+	if (target)
+	{
+		target->ApplyForceDelegate.Broadcast(direction, strength);
+	}
+}
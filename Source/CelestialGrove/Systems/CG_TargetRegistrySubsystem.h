@@ -0,0 +1,229 @@
+// ============================================================
+// FILE: CG_TargetRegistrySubsystem.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "CG_GlobalDefines.h"
+#include "CG_SpellTypes.h"
+#include "CG_TargetFilter.h"
+#include "CG_TargetRegistrySubsystem.generated.h"
+
+class AActor;
+class UPrimitiveComponent;
+
+// ============================================================
+enum class ESpellTargetKind : uint8
+{
+	ANIMATE = 0,
+	INANIMATE
+};
+
+#define SPELL_TARGET_KIND_COUNT 2
+
+// Targets are binned by their center, so a query only has to grow by this much of a cell to catch
+// anything whose bounds reach into it. Targets bigger than that all go in one cell every query checks.
+#define TARGET_CELL_LOOSENESS 0.5f
+#define LARGE_TARGET_CELL FIntVector(MAX_int32)
+
+// What an area effect still does to a target right at the edge of its query
+#define TARGET_MIN_EFFECT_SCALE 0.25f
+
+// ============================================================
+// Refers to a slot in the target registry. The generation changes every time the slot is reused
+// so a handle to a target that has since unregistered just stops resolving.
+struct FCG_TargetHandle
+{
+	int32 Slot = INDEX_NONE;
+	uint32 Generation = 0;
+
+	FORCEINLINE bool IsSet() const
+	{
+		return Slot != INDEX_NONE;
+	}
+
+	FORCEINLINE bool operator==(const FCG_TargetHandle & other) const
+	{
+		return Slot == other.Slot && Generation == other.Generation;
+	}
+};
+
+// ============================================================
+// What a spell keeps per target, the delegates stay with the target in the registry.
+struct FCG_TargetHit
+{
+	FCG_TargetHandle Handle;
+	FVector ImpactDirection;
+	float DistanceFalloff = 1.0f;
+
+	// Damage and force scale down toward the edge of an area query, but never all the way to nothing
+	FORCEINLINE float GetEffectScale() const
+	{
+		return FMath::Lerp(TARGET_MIN_EFFECT_SCALE, 1.0f, DistanceFalloff);
+	}
+};
+
+// ============================================================
+// Every spell target in the world bucketed into a loose uniform grid, one per target kind. Sphere
+// and cone queries only look at the cells they overlap instead of going through the physics scene,
+// and targets are matched by what they registered as instead of their exact class. Only targets
+// whose body moved since the last tick are re-read and re-binned.
+//
+// This is also the one place spell effects reach a target through, spells only hold handles.
+UCLASS(Config = Game)
+class CELESTIALGROVE_API UCG_TargetRegistrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+// ============================================================
+	UCG_TargetRegistrySubsystem();
+
+	virtual void Deinitialize() override;
+	virtual void Tick(float deltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	// The target has to stay at the same address until it's unregistered, actors register their
+	// Target member in BeginPlay and unregister in EndPlay. Impact directions point at body's center of mass.
+	FCG_TargetHandle RegisterTarget(AActor * actor, const FCG_SpellTarget * target, ESpellTargetKind kind, UPrimitiveComponent * body);
+	void UnregisterTarget(AActor * actor);
+
+	// ignoredActor is usually the caster, it's a target too but shouldn't catch its own spells
+	void GetTargetsInSphere(ESpellCollisionType type, const FVector & origin, float radius, const AActor * ignoredActor, TArray<FCG_TargetHit> & hits) const;
+	void GetTargetsInCone(ESpellCollisionType type, const FVector & origin, const FVector & forward, float radius, float angle, const AActor * ignoredActor, TArray<FCG_TargetHit> & hits) const;
+
+	// False if the actor isn't a registered target or collision type filters it out
+	bool FindTarget(const AActor * actor, ESpellCollisionType type, const FVector & origin, FCG_TargetHit & hit) const;
+	FCG_TargetHandle FindHandle(const AActor * actor) const;
+
+	// Null once the target has unregistered
+	FORCEINLINE const FCG_SpellTarget * GetTarget(FCG_TargetHandle handle) const;
+
+	void ApplyDamage(FCG_TargetHandle handle, int32 damage) const;
+	void ApplyStatus(FCG_TargetHandle handle, uint8 status) const;
+	void ApplyForce(FCG_TargetHandle handle, const FVector & direction, float strength) const;
+
+	FORCEINLINE int32 GetNumTargets() const;
+
+protected:
+// ============================================================
+	UPROPERTY(Config)
+	float CellSize;
+
+private:
+// ============================================================
+	void OnBodyMoved(USceneComponent * component, EUpdateTransformFlags flags, ETeleportType teleport, int32 slot);
+	void SetCell(int32 index, const FIntVector & cell);
+	void AddCandidates(const TArray<int32> * cell, int32 ignoredIndex) const;
+
+	FORCEINLINE FIntVector GetCell(const FVector & location) const;
+	FORCEINLINE FIntVector GetTargetCell(const FVector & location, float radius) const;
+	FORCEINLINE static bool AllowsKind(ESpellCollisionType type, ESpellTargetKind kind);
+	FORCEINLINE FVector GetLocation(int32 index) const;
+	FORCEINLINE int32 ResolveHandle(FCG_TargetHandle handle) const;
+	FORCEINLINE FCG_TargetHandle MakeHandle(int32 index) const;
+
+// ============================================================
+	// Packed, swap removed
+	TArray<TWeakObjectPtr<AActor>> Actors;
+	TArray<const FCG_SpellTarget *> Targets;
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Bodies;
+	TArray<float> LocationsX;
+	TArray<float> LocationsY;
+	TArray<float> LocationsZ;
+	TArray<float> Radii;
+	TArray<FIntVector> Cells;
+	TArray<ESpellTargetKind> Kinds;
+	TArray<FDelegateHandle> MovedHandles;
+	TArray<int32> IndexToSlot;
+
+	// Stable slot -> packed index, same as the spell runtime's ids but with a generation per slot
+	TArray<int32> SlotToIndex;
+	TArray<uint32> SlotGenerations;
+	TArray<int32> FreeSlots;
+
+	// Slots whose body moved since the last tick, flagged per slot so each is only queued once
+	TArray<int32> MovedSlots;
+	TArray<bool> HasSlotMoved;
+
+	TMap<const AActor *, int32> ActorToIndex;
+
+	// Cell -> packed indices of the targets in it
+	TMap<FIntVector, TArray<int32>> Grids[SPELL_TARGET_KIND_COUNT];
+
+	// Scratch for the filter, only ever touched on the game thread
+	mutable FCG_TargetCandidates Candidates;
+};
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_TargetRegistrySubsystem::GetNumTargets() const
+{
+	return Actors.Num();
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int32 UCG_TargetRegistrySubsystem::ResolveHandle(FCG_TargetHandle handle) const
+{
+	// NOTE(RyanC): Generations start at 1 so a default handle never resolves
+	if (!SlotGenerations.IsValidIndex(handle.Slot) || SlotGenerations[handle.Slot] != handle.Generation)
+	{
+		return INDEX_NONE;
+	}
+
+	return SlotToIndex[handle.Slot];
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE FCG_TargetHandle UCG_TargetRegistrySubsystem::MakeHandle(int32 index) const
+{
+	FCG_TargetHandle handle;
+	handle.Slot = IndexToSlot[index];
+	handle.Generation = SlotGenerations[handle.Slot];
+	return handle;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE const FCG_SpellTarget * UCG_TargetRegistrySubsystem::GetTarget(FCG_TargetHandle handle) const
+{
+	const int32 index = ResolveHandle(handle);
+	return (index != INDEX_NONE) ? Targets[index] : nullptr;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE FIntVector UCG_TargetRegistrySubsystem::GetCell(const FVector & location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(location.X / CellSize),
+		FMath::FloorToInt(location.Y / CellSize),
+		FMath::FloorToInt(location.Z / CellSize));
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE FIntVector UCG_TargetRegistrySubsystem::GetTargetCell(const FVector & location, float radius) const
+{
+	return (radius > CellSize * TARGET_CELL_LOOSENESS) ? LARGE_TARGET_CELL : GetCell(location);
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE FVector UCG_TargetRegistrySubsystem::GetLocation(int32 index) const
+{
+	return FVector(LocationsX[index], LocationsY[index], LocationsZ[index]);
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE bool UCG_TargetRegistrySubsystem::AllowsKind(ESpellCollisionType type, ESpellTargetKind kind)
+{
+	switch (type)
+	{
+		case ESpellCollisionType::INANIMATE_ONLY:
+			return kind == ESpellTargetKind::INANIMATE;
+
+		case ESpellCollisionType::ANIMATE_ONLY:
+			return kind == ESpellTargetKind::ANIMATE;
+
+		default:
+			return true;
+	}
+}
+// ============================================================
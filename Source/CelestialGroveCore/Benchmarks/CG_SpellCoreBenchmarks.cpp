@@ -0,0 +1,237 @@
+// ============================================================
+// FILE: CG_SpellCoreBenchmarks.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include "CG_CoreFlags.h"
+#include "CG_SpellCore.h"
+#include "CG_CooldownCore.h"
+
+using namespace CGCore;
+
+// -----------------------------------------------------------------------------------------
+static const FComponentStats & GetTestStats(uint8_t type)
+{
+	static FComponentStats stats[CG_CORE_COMPONENT_TYPE_COUNT];
+	static bool isInitialized = false;
+	if (!isInitialized)
+	{
+		for (int32_t i = 0; i < CG_CORE_COMPONENT_TYPE_COUNT; ++i)
+		{
+			stats[i].Type = (EComponentType)i;
+			stats[i].Category = (i <= (int32_t)EComponentType::FOREWARD_TARGETING) ? EComponentCategory::TARGETING
+				: (i <= (int32_t)EComponentType::ELECTRIC_EFFECT) ? EComponentCategory::EFFECT
+				: EComponentCategory::MODIFIERS;
+			stats[i].EffectModifier = 1.25f;
+			stats[i].CooldownModifier = 0.9f;
+		}
+
+		isInitialized = true;
+	}
+
+	return stats[type];
+}
+
+// -----------------------------------------------------------------------------------------
+// Every component set with at least one targeting and one effect component, effects first, the
+// same combinations the engine side BuildSpell benchmark goes through.
+static std::vector<std::vector<uint8_t>> MakeCombinations()
+{
+	std::vector<std::vector<uint8_t>> combinations;
+	for (int32_t mask = 1; mask < (1 << CG_CORE_COMPONENT_TYPE_COUNT); ++mask)
+	{
+		if ((mask & ALL_TARGETING_FLAGS) == 0 || (mask & (0x7 << (int32_t)EComponentType::FIRE_EFFECT)) == 0)
+		{
+			continue;
+		}
+
+		std::vector<uint8_t> & types = combinations.emplace_back();
+		for (int32_t pass = 0; pass < 2; ++pass)
+		{
+			for (int32_t type = 0; type < CG_CORE_COMPONENT_TYPE_COUNT; ++type)
+			{
+				const bool isEffect = GetTestStats((uint8_t)type).Category == EComponentCategory::EFFECT;
+				if ((mask & (1 << type)) != 0 && isEffect == (pass == 0))
+				{
+					types.push_back((uint8_t)type);
+				}
+			}
+		}
+	}
+
+	return combinations;
+}
+
+// -----------------------------------------------------------------------------------------
+static ETargetingStyle TargetingStyleChain(int32_t targetField, int32_t numTargeting)
+{
+	if (numTargeting >= 3)
+	{
+		return ETargetingStyle::CONE;
+	}
+
+	if (COMPARE_FLAG(targetField, RADIUS_AT_ORIGIN_FLAG))
+	{
+		return ETargetingStyle::RADIUS_AT_ORIGIN;
+	}
+	else if (COMPARE_FLAG(targetField, BEAM_FLAG))
+	{
+		return ETargetingStyle::BEAM;
+	}
+	else if (COMPARE_FLAG(targetField, SELF_FORWARD_FLAG))
+	{
+		return ETargetingStyle::SELF_FORWARD;
+	}
+	else if (COMPARE_FLAG(targetField, RADIUS_AT_POINT_FLAG))
+	{
+		return ETargetingStyle::RADIUS_AT_POINT;
+	}
+	else if (COMPARE_FLAG(targetField, TARGET_SELF_FLAG))
+	{
+		return ETargetingStyle::TARGET_SELF;
+	}
+	else if (COMPARE_FLAG(targetField, PROJECTILE_FLAG))
+	{
+		return ETargetingStyle::PROJECTILE;
+	}
+
+	return ETargetingStyle::INVALID;
+}
+
+// -----------------------------------------------------------------------------------------
+// One op is folding every combination once
+static void BM_FoldComponents(benchmark::State & state)
+{
+	const std::vector<std::vector<uint8_t>> combinations = MakeCombinations();
+
+	for (auto _ : state)
+	{
+		for (const std::vector<uint8_t> & types : combinations)
+		{
+			FSpellFold fold = FoldComponents(types.data(), (int32_t)types.size(), GetTestStats);
+			benchmark::DoNotOptimize(fold);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * combinations.size());
+}
+BENCHMARK(BM_FoldComponents);
+
+// -----------------------------------------------------------------------------------------
+static void BM_MakeSpellKey(benchmark::State & state)
+{
+	const std::vector<std::vector<uint8_t>> combinations = MakeCombinations();
+
+	for (auto _ : state)
+	{
+		for (const std::vector<uint8_t> & types : combinations)
+		{
+			uint64_t key = 0;
+			benchmark::DoNotOptimize(MakeSpellKey(types.data(), (int32_t)types.size(), key));
+			benchmark::DoNotOptimize(key);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * combinations.size());
+}
+BENCHMARK(BM_MakeSpellKey);
+
+// -----------------------------------------------------------------------------------------
+// Table lookup against the if chain it replaced, over random masks so the branches can't be learned
+static std::vector<uint16_t> MakeTargetingMasks()
+{
+	std::mt19937 random(1337);
+	std::uniform_int_distribution<int32_t> distribution(1, ALL_TARGETING_FLAGS);
+
+	std::vector<uint16_t> masks(4096);
+	for (uint16_t & mask : masks)
+	{
+		mask = (uint16_t)distribution(random);
+	}
+
+	return masks;
+}
+
+// -----------------------------------------------------------------------------------------
+static void BM_TargetingStyleTable(benchmark::State & state)
+{
+	const std::vector<uint16_t> masks = MakeTargetingMasks();
+
+	for (auto _ : state)
+	{
+		for (uint16_t mask : masks)
+		{
+			benchmark::DoNotOptimize(GetTargetingStyle(mask, 2));
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * masks.size());
+}
+BENCHMARK(BM_TargetingStyleTable);
+
+// -----------------------------------------------------------------------------------------
+static void BM_TargetingStyleChain(benchmark::State & state)
+{
+	const std::vector<uint16_t> masks = MakeTargetingMasks();
+
+	for (auto _ : state)
+	{
+		for (uint16_t mask : masks)
+		{
+			benchmark::DoNotOptimize(TargetingStyleChain(mask, 2));
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * masks.size());
+}
+BENCHMARK(BM_TargetingStyleChain);
+
+// -----------------------------------------------------------------------------------------
+static void BM_CountOnCooldown(benchmark::State & state)
+{
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<double> distribution(0.0, 100.0);
+
+	std::vector<double> endTimes((size_t)state.range(0));
+	for (double & endTime : endTimes)
+	{
+		endTime = distribution(random);
+	}
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(CountOnCooldown(endTimes.data(), (int32_t)endTimes.size(), 50.0));
+	}
+
+	state.SetItemsProcessed(state.iterations() * endTimes.size());
+}
+BENCHMARK(BM_CountOnCooldown)->Arg(64)->Arg(1024)->Arg(16384);
+
+// -----------------------------------------------------------------------------------------
+static void BM_RemainingCooldown(benchmark::State & state)
+{
+	std::mt19937 random(1337);
+	std::uniform_real_distribution<double> distribution(0.0, 100.0);
+
+	std::vector<double> endTimes(1024);
+	for (double & endTime : endTimes)
+	{
+		endTime = distribution(random);
+	}
+
+	for (auto _ : state)
+	{
+		float total = 0.0f;
+		for (double endTime : endTimes)
+		{
+			total += GetRemainingCooldown(endTime, 0.0f, 50.0);
+		}
+		benchmark::DoNotOptimize(total);
+	}
+
+	state.SetItemsProcessed(state.iterations() * endTimes.size());
+}
+BENCHMARK(BM_RemainingCooldown);
@@ -0,0 +1,69 @@
+// ============================================================
+// FILE: CG_CooldownCore.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+// ============================================================
+// Cooldown math for Celestial Grove
+// ============================================================
+// A spell's cooldown only starts counting once it has finished casting. Until then its end time
+// is pending (never reached) and the full cooldown is kept to one side.
+namespace CGCore
+{
+
+constexpr double GCooldownPendingEndTime = std::numeric_limits<double>::max();
+
+// -----------------------------------------------------------------------------------------
+// End time while the spell is still being cast
+constexpr double GetCastingEndTime(float cooldown)
+{
+	return (cooldown > 0.0f) ? GCooldownPendingEndTime : 0.0;
+}
+
+// -----------------------------------------------------------------------------------------
+constexpr double GetCooldownEndTime(double now, float cooldown)
+{
+	return now + cooldown;
+}
+
+// -----------------------------------------------------------------------------------------
+constexpr bool IsOnCooldown(double endTime, double now)
+{
+	return endTime > now;
+}
+
+// -----------------------------------------------------------------------------------------
+// pendingCooldown is only set while casting, the whole cooldown is still left then
+constexpr float GetRemainingCooldown(double endTime, float pendingCooldown, double now)
+{
+	if (pendingCooldown > 0.0f)
+	{
+		return pendingCooldown;
+	}
+
+	return (endTime > now) ? (float)(endTime - now) : 0.0f;
+}
+
+// -----------------------------------------------------------------------------------------
+// Branch free so it vectorizes, for counting or polling a whole packed array at once
+inline int32_t CountOnCooldown(const double * endTimes, int32_t count, double now)
+{
+	int32_t onCooldown = 0;
+	for (int32_t i = 0; i < count; ++i)
+	{
+		onCooldown += (endTimes[i] > now) ? 1 : 0;
+	}
+
+	return onCooldown;
+}
+
+static_assert(IsOnCooldown(GetCastingEndTime(1.0f), 1.0e9), "A spell being cast is on cooldown until it finishes");
+static_assert(!IsOnCooldown(GetCastingEndTime(0.0f), 0.0), "No cooldown means never on cooldown");
+static_assert(GetRemainingCooldown(GetCooldownEndTime(10.0, 2.0f), 0.0f, 11.0) == 1.0f, "");
+
+} // namespace CGCore
@@ -0,0 +1,35 @@
+// ============================================================
+// FILE: CG_CoreFlags.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+// ============================================================
+// Bit flag helpers for Celestial Grove
+// ============================================================
+// No engine includes, these are shared by the game module and the standalone core build.
+#define COMPARE_FLAG(field, flag) (((field) & (flag)) == (flag))
+#define TOGGLE_FLAG(field, flag) ((field) = (field) ^ (flag))
+#define SET_FLAG(field, flag) ((field) = (field) | (flag))
+#define CLEAR_FLAG(field, flag) ((field) = (field) & ~(flag))
+
+namespace CGCore
+{
+
+// -----------------------------------------------------------------------------------------
+// Same as COMPARE_FLAG, for when the result is needed in a constant expression
+template <typename FieldType, typename FlagType>
+constexpr bool HasFlags(FieldType field, FlagType flag)
+{
+	return (field & flag) == flag;
+}
+
+// -----------------------------------------------------------------------------------------
+template <typename FieldType, typename FlagType>
+constexpr bool HasAnyFlags(FieldType field, FlagType flag)
+{
+	return (field & flag) != 0;
+}
+
+} // namespace CGCore
@@ -0,0 +1,73 @@
+// ============================================================
+// FILE: CG_RingCore.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// ============================================================
+// Lock free rings for Celestial Grove
+// ============================================================
+// One producer thread and one consumer thread, neither ever waits on the other. The items live
+// inline so a ring never allocates after it's created.
+namespace CGCore
+{
+
+// ============================================================
+template <typename ItemType, uint32_t Capacity>
+struct TSpscRing
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Ring capacity has to be a power of two");
+
+	// -----------------------------------------------------------------------------------------
+	// Producer only. False if the ring is full, nothing is written then.
+	bool Push(const ItemType & item)
+	{
+		const uint32_t head = Head.load(std::memory_order_relaxed);
+		if (head - Tail.load(std::memory_order_acquire) == Capacity)
+		{
+			return false;
+		}
+
+		Items[head & (Capacity - 1)] = item;
+		Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// -----------------------------------------------------------------------------------------
+	// Consumer only. Hands everything pushed so far to drain in the order it was pushed, then frees
+	// its room. Returns how many items were drained.
+	template <typename DrainFn>
+	uint32_t Drain(DrainFn && drain)
+	{
+		const uint32_t tail = Tail.load(std::memory_order_relaxed);
+		const uint32_t head = Head.load(std::memory_order_acquire);
+
+		for (uint32_t i = tail; i != head; ++i)
+		{
+			drain(Items[i & (Capacity - 1)]);
+		}
+
+		Tail.store(head, std::memory_order_release);
+		return head - tail;
+	}
+
+	// -----------------------------------------------------------------------------------------
+	// Only exact when called from the producer or the consumer while the other is idle
+	uint32_t Num() const
+	{
+		return Head.load(std::memory_order_acquire) - Tail.load(std::memory_order_acquire);
+	}
+
+// ============================================================
+	// NOTE(RyanC): Counters run freely and wrap, only their difference matters. Kept on their own
+	// cache lines so the producer and consumer don't fight over them.
+	alignas(64) std::atomic<uint32_t> Head { 0 };
+	alignas(64) std::atomic<uint32_t> Tail { 0 };
+	alignas(64) ItemType Items[Capacity];
+};
+
+} // namespace CGCore
@@ -0,0 +1,257 @@
+// ============================================================
+// FILE: CG_SpellCore.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include <cstdint>
+#include "CG_CoreFlags.h"
+
+// ============================================================
+// Spell algebra for Celestial Grove
+// ============================================================
+// Everything about building a spell that only depends on which components went into it: folding
+// the component values together, the category masks, the targeting style and the cache key. No
+// engine types in here, the game module mirrors these enums as UENUMs and static_asserts that
+// they line up (see CG_SpellTypes.h).
+namespace CGCore
+{
+
+// ============================================================
+enum class EComponentCategory : uint8_t
+{
+	NONE = 0,
+	TARGETING,
+	EFFECT,
+	MODIFIERS
+};
+
+#define CG_CORE_COMPONENT_CATEGORY_COUNT ((int32_t)CGCore::EComponentCategory::MODIFIERS + 1)
+
+// ============================================================
+enum class EComponentType : uint8_t
+{
+	// ============================================================
+	// Targeting Components
+	RADIUS_TARGETING = 0,
+	SELF_TARGETING,
+	FOREWARD_TARGETING,
+
+	// ============================================================
+	// Effect Components
+	FIRE_EFFECT,
+	TELEKINETIC_EFFECT,
+	ELECTRIC_EFFECT,
+
+	// ============================================================
+	// Modifier Components
+	AMPLIFY_MODIFIER,
+	INANIMATE_MODIFIER,
+	QUICK_MODIFIER,
+	CONTINUOUS_MODIFIER
+};
+
+#define CG_CORE_COMPONENT_TYPE_COUNT ((int32_t)CGCore::EComponentType::CONTINUOUS_MODIFIER + 1)
+
+#define RADIUS_AT_POINT_FLAG (1<<(int32_t)CGCore::EComponentType::RADIUS_TARGETING)
+#define TARGET_SELF_FLAG (1<<(int32_t)CGCore::EComponentType::SELF_TARGETING)
+#define PROJECTILE_FLAG (1<<(int32_t)CGCore::EComponentType::FOREWARD_TARGETING)
+#define RADIUS_AT_ORIGIN_FLAG (RADIUS_AT_POINT_FLAG | TARGET_SELF_FLAG)
+#define BEAM_FLAG (RADIUS_AT_POINT_FLAG | PROJECTILE_FLAG)
+#define SELF_FORWARD_FLAG (PROJECTILE_FLAG | TARGET_SELF_FLAG)
+#define ALL_TARGETING_FLAGS (RADIUS_AT_POINT_FLAG | TARGET_SELF_FLAG | PROJECTILE_FLAG)
+
+// ============================================================
+enum class ETargetingStyle : uint8_t
+{
+	RADIUS_AT_POINT = 0,
+	TARGET_SELF,
+	PROJECTILE,
+	RADIUS_AT_ORIGIN,
+	BEAM,
+	SELF_FORWARD,
+	CONE,
+
+	// No targeting components at all, never a real spell
+	INVALID
+};
+
+// ============================================================
+// The key packs a 4 bit count for every component type, then the base component's type and the
+// effect base's (the first effect component) in the top byte. Both are kept separately since
+// they're the components that don't get folded.
+#define CG_CORE_KEY_COUNT_BITS 4
+#define CG_CORE_KEY_MAX_COUNT ((1 << CG_CORE_KEY_COUNT_BITS) - 1)
+#define CG_CORE_KEY_BASE_SHIFT 56
+#define CG_CORE_KEY_EFFECT_BASE_SHIFT 60
+#define CG_CORE_KEY_TYPE_MASK 0xF
+
+static_assert(CG_CORE_COMPONENT_TYPE_COUNT * CG_CORE_KEY_COUNT_BITS <= CG_CORE_KEY_BASE_SHIFT, "Too many component types to fit in the compiled spell key");
+static_assert(CG_CORE_COMPONENT_TYPE_COUNT <= 16, "Component masks are 16 bits");
+
+// ============================================================
+// Gameplay values of one component. The game keeps its own copy (FCG_SpellComponentStats) with
+// the same fields, FoldComponents takes either.
+struct FComponentStats
+{
+	EComponentCategory Category = EComponentCategory::NONE;
+	EComponentType Type = EComponentType::RADIUS_TARGETING;
+
+	int32_t BaseEffectStrength = 10;
+	float BaseTargetStrength = 10.f;
+	float BaseCooldown = 1.0f;
+
+	float EffectModifier = 1.0f;
+	float TargetModifier = 1.0f;
+	float CooldownModifier = 1.0f;
+};
+
+// ============================================================
+struct FSpellFold
+{
+	// Bit (1 << component type) is set for every component type in the category
+	uint16_t CategoryMasks[CG_CORE_COMPONENT_CATEGORY_COUNT] = {};
+	int32_t CategoryCounts[CG_CORE_COMPONENT_CATEGORY_COUNT] = {};
+
+	float EffectStrength = 0.0f;
+	float TargetStrength = 0.0f;
+	float Cooldown = 0.0f;
+};
+
+// -----------------------------------------------------------------------------------------
+// The first component is the base, its values are the starting point and every other component
+// modifies them: cooldown and effect strength multiply, target strength adds.
+// getStats(uint8_t type) returns anything with FComponentStats' fields.
+template <typename StatsLookupType>
+constexpr FSpellFold FoldComponents(const uint8_t * types, int32_t count, StatsLookupType && getStats)
+{
+	FSpellFold fold;
+	if (count <= 0)
+	{
+		return fold;
+	}
+
+	const auto & base = getStats(types[0]);
+	fold.EffectStrength = (float)base.BaseEffectStrength;
+	fold.TargetStrength = base.BaseTargetStrength;
+	fold.Cooldown = base.BaseCooldown;
+
+	for (int32_t i = 0; i < count; ++i)
+	{
+		const auto & stats = getStats(types[i]);
+		const int32_t category = (int32_t)stats.Category;
+
+		SET_FLAG(fold.CategoryMasks[category], (uint16_t)(1 << (int32_t)types[i]));
+		++fold.CategoryCounts[category];
+
+		// NOTE(RyanC): Base should not modify itself
+		if (i != 0)
+		{
+			fold.Cooldown *= stats.CooldownModifier;
+			fold.EffectStrength *= stats.EffectModifier;
+			fold.TargetStrength += stats.TargetModifier;
+		}
+	}
+
+	return fold;
+}
+
+// -----------------------------------------------------------------------------------------
+// Needs at least one targeting and one effect component
+constexpr bool IsValidSpell(const FSpellFold & fold)
+{
+	return fold.CategoryCounts[(int32_t)EComponentCategory::TARGETING] > 0 && fold.CategoryCounts[(int32_t)EComponentCategory::EFFECT] > 0;
+}
+
+// ============================================================
+// Style for every combination of the three targeting bits. Two component styles win over single
+// component ones, all three only shows up with three or more components which is always a cone.
+constexpr ETargetingStyle GTargetingStyleTable[ALL_TARGETING_FLAGS + 1] =
+{
+	ETargetingStyle::INVALID,
+	ETargetingStyle::RADIUS_AT_POINT,
+	ETargetingStyle::TARGET_SELF,
+	ETargetingStyle::RADIUS_AT_ORIGIN,
+	ETargetingStyle::PROJECTILE,
+	ETargetingStyle::BEAM,
+	ETargetingStyle::SELF_FORWARD,
+	ETargetingStyle::RADIUS_AT_ORIGIN
+};
+
+// -----------------------------------------------------------------------------------------
+// targetingMask is the targeting category mask, numTargeting counts duplicates
+constexpr ETargetingStyle GetTargetingStyle(uint16_t targetingMask, int32_t numTargeting)
+{
+	if (numTargeting >= 3)
+	{
+		return ETargetingStyle::CONE;
+	}
+
+	return GTargetingStyleTable[targetingMask & ALL_TARGETING_FLAGS];
+}
+
+// -----------------------------------------------------------------------------------------
+// False if one component type shows up more often than its count can hold, key is only valid
+// when this returns true.
+constexpr bool MakeSpellKey(const uint8_t * types, int32_t count, uint64_t & key)
+{
+	key = 0;
+	if (count <= 0)
+	{
+		return false;
+	}
+
+	key = (uint64_t)types[0] << CG_CORE_KEY_BASE_SHIFT;
+	for (int32_t i = 0; i < count; ++i)
+	{
+		const uint32_t shift = (uint32_t)types[i] * CG_CORE_KEY_COUNT_BITS;
+		if (((key >> shift) & CG_CORE_KEY_MAX_COUNT) == CG_CORE_KEY_MAX_COUNT)
+		{
+			return false;
+		}
+
+		key += (uint64_t)1 << shift;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------------------
+// The game knows which components are effects, MakeSpellKey only sees types
+constexpr void SetKeyEffectBase(uint64_t & key, EComponentType effectBase)
+{
+	key &= ~((uint64_t)CG_CORE_KEY_TYPE_MASK << CG_CORE_KEY_EFFECT_BASE_SHIFT);
+	key |= (uint64_t)effectBase << CG_CORE_KEY_EFFECT_BASE_SHIFT;
+}
+
+// -----------------------------------------------------------------------------------------
+constexpr int32_t GetKeyCount(uint64_t key, EComponentType type)
+{
+	return (int32_t)((key >> ((uint32_t)type * CG_CORE_KEY_COUNT_BITS)) & CG_CORE_KEY_MAX_COUNT);
+}
+
+// -----------------------------------------------------------------------------------------
+constexpr EComponentType GetKeyBase(uint64_t key)
+{
+	return (EComponentType)((key >> CG_CORE_KEY_BASE_SHIFT) & CG_CORE_KEY_TYPE_MASK);
+}
+
+// -----------------------------------------------------------------------------------------
+constexpr EComponentType GetKeyEffectBase(uint64_t key)
+{
+	return (EComponentType)((key >> CG_CORE_KEY_EFFECT_BASE_SHIFT) & CG_CORE_KEY_TYPE_MASK);
+}
+
+// ============================================================
+// Checked at compile time so the table above can't drift from the order the checks used to run in
+static_assert(GetTargetingStyle(RADIUS_AT_POINT_FLAG, 1) == ETargetingStyle::RADIUS_AT_POINT, "");
+static_assert(GetTargetingStyle(TARGET_SELF_FLAG, 1) == ETargetingStyle::TARGET_SELF, "");
+static_assert(GetTargetingStyle(PROJECTILE_FLAG, 1) == ETargetingStyle::PROJECTILE, "");
+static_assert(GetTargetingStyle(RADIUS_AT_ORIGIN_FLAG, 2) == ETargetingStyle::RADIUS_AT_ORIGIN, "");
+static_assert(GetTargetingStyle(BEAM_FLAG, 2) == ETargetingStyle::BEAM, "");
+static_assert(GetTargetingStyle(SELF_FORWARD_FLAG, 2) == ETargetingStyle::SELF_FORWARD, "");
+static_assert(GetTargetingStyle(RADIUS_AT_POINT_FLAG, 3) == ETargetingStyle::CONE, "");
+static_assert(GetTargetingStyle(0, 0) == ETargetingStyle::INVALID, "");
+
+} // namespace CGCore
@@ -0,0 +1,351 @@
+// ============================================================
+// FILE: CG_SpellCoreTests.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "CG_CoreFlags.h"
+#include "CG_SpellCore.h"
+#include "CG_CooldownCore.h"
+#include "CG_RingCore.h"
+
+using namespace CGCore;
+
+// ============================================================
+// Stand in for the component table, values picked so every fold step shows up in the results
+struct FTestComponentTable
+{
+	FTestComponentTable()
+	{
+		for (int32_t i = 0; i < CG_CORE_COMPONENT_TYPE_COUNT; ++i)
+		{
+			FComponentStats & stats = Stats[i];
+			stats.Type = (EComponentType)i;
+			stats.Category = (i <= (int32_t)EComponentType::FOREWARD_TARGETING) ? EComponentCategory::TARGETING
+				: (i <= (int32_t)EComponentType::ELECTRIC_EFFECT) ? EComponentCategory::EFFECT
+				: EComponentCategory::MODIFIERS;
+
+			stats.BaseEffectStrength = 10 + i;
+			stats.BaseTargetStrength = 100.0f + i;
+			stats.BaseCooldown = 1.0f + i;
+			stats.EffectModifier = 2.0f;
+			stats.TargetModifier = 5.0f;
+			stats.CooldownModifier = 0.5f;
+		}
+	}
+
+	const FComponentStats & operator()(uint8_t type) const
+	{
+		return Stats[type];
+	}
+
+	FComponentStats Stats[CG_CORE_COMPONENT_TYPE_COUNT];
+};
+
+// -----------------------------------------------------------------------------------------
+static FSpellFold Fold(std::initializer_list<EComponentType> components)
+{
+	static const FTestComponentTable table;
+	std::vector<uint8_t> types;
+	for (EComponentType type : components)
+	{
+		types.push_back((uint8_t)type);
+	}
+
+	return FoldComponents(types.data(), (int32_t)types.size(), table);
+}
+
+// -----------------------------------------------------------------------------------------
+// How the game picked the style before it was a table, kept to check the table against
+static ETargetingStyle ReferenceTargetingStyle(int32_t targetField, int32_t numTargeting)
+{
+	if (numTargeting >= 3)
+	{
+		return ETargetingStyle::CONE;
+	}
+
+	if (COMPARE_FLAG(targetField, RADIUS_AT_ORIGIN_FLAG))
+	{
+		return ETargetingStyle::RADIUS_AT_ORIGIN;
+	}
+	else if (COMPARE_FLAG(targetField, BEAM_FLAG))
+	{
+		return ETargetingStyle::BEAM;
+	}
+	else if (COMPARE_FLAG(targetField, SELF_FORWARD_FLAG))
+	{
+		return ETargetingStyle::SELF_FORWARD;
+	}
+	else if (COMPARE_FLAG(targetField, RADIUS_AT_POINT_FLAG))
+	{
+		return ETargetingStyle::RADIUS_AT_POINT;
+	}
+	else if (COMPARE_FLAG(targetField, TARGET_SELF_FLAG))
+	{
+		return ETargetingStyle::TARGET_SELF;
+	}
+	else if (COMPARE_FLAG(targetField, PROJECTILE_FLAG))
+	{
+		return ETargetingStyle::PROJECTILE;
+	}
+
+	return ETargetingStyle::INVALID;
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(CoreFlags, CompareNeedsEveryBit)
+{
+	const uint16_t field = RADIUS_AT_POINT_FLAG | PROJECTILE_FLAG;
+
+	EXPECT_TRUE(COMPARE_FLAG(field, BEAM_FLAG));
+	EXPECT_TRUE(COMPARE_FLAG(field, RADIUS_AT_POINT_FLAG));
+	EXPECT_FALSE(COMPARE_FLAG(field, RADIUS_AT_ORIGIN_FLAG));
+	EXPECT_TRUE(HasAnyFlags(field, RADIUS_AT_ORIGIN_FLAG));
+	EXPECT_FALSE(HasFlags(field, SELF_FORWARD_FLAG));
+
+	// Unparenthesized flag expressions used to bind to the & first
+	EXPECT_FALSE(COMPARE_FLAG(field, TARGET_SELF_FLAG | PROJECTILE_FLAG));
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(CoreFlags, SetClearToggle)
+{
+	uint8_t field = 0;
+
+	SET_FLAG(field, 0x01 | 0x04);
+	EXPECT_EQ(field, 0x05);
+
+	CLEAR_FLAG(field, 0x01);
+	EXPECT_EQ(field, 0x04);
+
+	TOGGLE_FLAG(field, 0x06);
+	EXPECT_EQ(field, 0x02);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, TargetingStyleMatchesReference)
+{
+	for (int32_t mask = 0; mask <= ALL_TARGETING_FLAGS; ++mask)
+	{
+		for (int32_t numTargeting = 0; numTargeting <= 4; ++numTargeting)
+		{
+			EXPECT_EQ(GetTargetingStyle((uint16_t)mask, numTargeting), ReferenceTargetingStyle(mask, numTargeting))
+				<< "mask " << mask << ", " << numTargeting << " targeting components";
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, TargetingStyleIgnoresOtherCategories)
+{
+	const uint16_t mask = BEAM_FLAG | (1 << (int32_t)EComponentType::FIRE_EFFECT);
+	EXPECT_EQ(GetTargetingStyle(mask, 2), ETargetingStyle::BEAM);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, BaseDoesNotModifyItself)
+{
+	const FSpellFold fold = Fold({ EComponentType::FIRE_EFFECT });
+
+	EXPECT_FLOAT_EQ(fold.EffectStrength, 13.0f);
+	EXPECT_FLOAT_EQ(fold.TargetStrength, 103.0f);
+	EXPECT_FLOAT_EQ(fold.Cooldown, 4.0f);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, ModifiersFoldIntoBase)
+{
+	const FSpellFold fold = Fold({ EComponentType::FIRE_EFFECT, EComponentType::RADIUS_TARGETING, EComponentType::AMPLIFY_MODIFIER });
+
+	// Two components on top of the base, effect and cooldown multiply, target strength adds
+	EXPECT_FLOAT_EQ(fold.EffectStrength, 13.0f * 2.0f * 2.0f);
+	EXPECT_FLOAT_EQ(fold.TargetStrength, 103.0f + 5.0f + 5.0f);
+	EXPECT_FLOAT_EQ(fold.Cooldown, 4.0f * 0.5f * 0.5f);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, MasksAndCounts)
+{
+	const FSpellFold fold = Fold({ EComponentType::ELECTRIC_EFFECT, EComponentType::RADIUS_TARGETING, EComponentType::RADIUS_TARGETING,
+		EComponentType::SELF_TARGETING, EComponentType::QUICK_MODIFIER });
+
+	EXPECT_EQ(fold.CategoryMasks[(int32_t)EComponentCategory::TARGETING], RADIUS_AT_ORIGIN_FLAG);
+	EXPECT_EQ(fold.CategoryMasks[(int32_t)EComponentCategory::EFFECT], 1 << (int32_t)EComponentType::ELECTRIC_EFFECT);
+	EXPECT_EQ(fold.CategoryMasks[(int32_t)EComponentCategory::MODIFIERS], 1 << (int32_t)EComponentType::QUICK_MODIFIER);
+	EXPECT_EQ(fold.CategoryMasks[(int32_t)EComponentCategory::NONE], 0);
+
+	EXPECT_EQ(fold.CategoryCounts[(int32_t)EComponentCategory::TARGETING], 3);
+	EXPECT_EQ(fold.CategoryCounts[(int32_t)EComponentCategory::EFFECT], 1);
+	EXPECT_EQ(fold.CategoryCounts[(int32_t)EComponentCategory::MODIFIERS], 1);
+
+	// Duplicates count towards the cone even though the mask only has two bits
+	EXPECT_EQ(GetTargetingStyle(fold.CategoryMasks[(int32_t)EComponentCategory::TARGETING], fold.CategoryCounts[(int32_t)EComponentCategory::TARGETING]),
+		ETargetingStyle::CONE);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, ValidSpellNeedsTargetingAndEffect)
+{
+	EXPECT_TRUE(IsValidSpell(Fold({ EComponentType::FIRE_EFFECT, EComponentType::SELF_TARGETING })));
+	EXPECT_FALSE(IsValidSpell(Fold({ EComponentType::FIRE_EFFECT, EComponentType::AMPLIFY_MODIFIER })));
+	EXPECT_FALSE(IsValidSpell(Fold({ EComponentType::SELF_TARGETING })));
+	EXPECT_FALSE(IsValidSpell(Fold({})));
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, KeyIgnoresOrderAfterBase)
+{
+	const uint8_t a[] = { (uint8_t)EComponentType::FIRE_EFFECT, (uint8_t)EComponentType::RADIUS_TARGETING, (uint8_t)EComponentType::QUICK_MODIFIER };
+	const uint8_t b[] = { (uint8_t)EComponentType::FIRE_EFFECT, (uint8_t)EComponentType::QUICK_MODIFIER, (uint8_t)EComponentType::RADIUS_TARGETING };
+	const uint8_t c[] = { (uint8_t)EComponentType::RADIUS_TARGETING, (uint8_t)EComponentType::FIRE_EFFECT, (uint8_t)EComponentType::QUICK_MODIFIER };
+
+	uint64_t keyA = 0;
+	uint64_t keyB = 0;
+	uint64_t keyC = 0;
+	ASSERT_TRUE(MakeSpellKey(a, 3, keyA));
+	ASSERT_TRUE(MakeSpellKey(b, 3, keyB));
+	ASSERT_TRUE(MakeSpellKey(c, 3, keyC));
+
+	EXPECT_EQ(keyA, keyB);
+	EXPECT_NE(keyA, keyC);
+
+	EXPECT_EQ(GetKeyBase(keyA), EComponentType::FIRE_EFFECT);
+	EXPECT_EQ(GetKeyBase(keyC), EComponentType::RADIUS_TARGETING);
+	EXPECT_EQ(GetKeyCount(keyA, EComponentType::QUICK_MODIFIER), 1);
+	EXPECT_EQ(GetKeyCount(keyA, EComponentType::AMPLIFY_MODIFIER), 0);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, KeyKeepsEffectBase)
+{
+	const uint8_t a[] = { (uint8_t)EComponentType::RADIUS_TARGETING, (uint8_t)EComponentType::FIRE_EFFECT, (uint8_t)EComponentType::ELECTRIC_EFFECT };
+	const uint8_t b[] = { (uint8_t)EComponentType::RADIUS_TARGETING, (uint8_t)EComponentType::ELECTRIC_EFFECT, (uint8_t)EComponentType::FIRE_EFFECT };
+
+	uint64_t keyA = 0;
+	uint64_t keyB = 0;
+	ASSERT_TRUE(MakeSpellKey(a, 3, keyA));
+	ASSERT_TRUE(MakeSpellKey(b, 3, keyB));
+	EXPECT_EQ(keyA, keyB);
+
+	SetKeyEffectBase(keyA, EComponentType::FIRE_EFFECT);
+	SetKeyEffectBase(keyB, EComponentType::ELECTRIC_EFFECT);
+	EXPECT_NE(keyA, keyB);
+
+	EXPECT_EQ(GetKeyBase(keyA), EComponentType::RADIUS_TARGETING);
+	EXPECT_EQ(GetKeyBase(keyB), EComponentType::RADIUS_TARGETING);
+	EXPECT_EQ(GetKeyEffectBase(keyA), EComponentType::FIRE_EFFECT);
+	EXPECT_EQ(GetKeyEffectBase(keyB), EComponentType::ELECTRIC_EFFECT);
+	EXPECT_EQ(GetKeyCount(keyA, EComponentType::ELECTRIC_EFFECT), 1);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(SpellCore, KeyRejectsTooManyCopies)
+{
+	std::vector<uint8_t> types(CG_CORE_KEY_MAX_COUNT, (uint8_t)EComponentType::AMPLIFY_MODIFIER);
+
+	uint64_t key = 0;
+	ASSERT_TRUE(MakeSpellKey(types.data(), (int32_t)types.size(), key));
+	EXPECT_EQ(GetKeyCount(key, EComponentType::AMPLIFY_MODIFIER), CG_CORE_KEY_MAX_COUNT);
+
+	types.push_back((uint8_t)EComponentType::AMPLIFY_MODIFIER);
+	EXPECT_FALSE(MakeSpellKey(types.data(), (int32_t)types.size(), key));
+	EXPECT_FALSE(MakeSpellKey(types.data(), 0, key));
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(CooldownCore, PendingUntilCastFinishes)
+{
+	const double endTime = GetCastingEndTime(2.0f);
+
+	EXPECT_TRUE(IsOnCooldown(endTime, 1.0e12));
+	EXPECT_FLOAT_EQ(GetRemainingCooldown(endTime, 2.0f, 50.0), 2.0f);
+	EXPECT_FALSE(IsOnCooldown(GetCastingEndTime(0.0f), 0.0));
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(CooldownCore, CountsDownOnceStarted)
+{
+	const double endTime = GetCooldownEndTime(10.0, 2.0f);
+
+	EXPECT_TRUE(IsOnCooldown(endTime, 11.5));
+	EXPECT_FLOAT_EQ(GetRemainingCooldown(endTime, 0.0f, 11.5), 0.5f);
+	EXPECT_FALSE(IsOnCooldown(endTime, 12.0));
+	EXPECT_FLOAT_EQ(GetRemainingCooldown(endTime, 0.0f, 20.0), 0.0f);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(CooldownCore, CountOnCooldown)
+{
+	const double endTimes[] = { 0.0, 5.0, 10.0, GCooldownPendingEndTime, 4.0 };
+
+	EXPECT_EQ(CountOnCooldown(endTimes, 5, 4.5), 3);
+	EXPECT_EQ(CountOnCooldown(endTimes, 5, 100.0), 1);
+	EXPECT_EQ(CountOnCooldown(endTimes, 0, 0.0), 0);
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(RingCore, DrainsInPushOrderAndRejectsWhenFull)
+{
+	std::unique_ptr<TSpscRing<int32_t, 4>> ring = std::make_unique<TSpscRing<int32_t, 4>>();
+
+	for (int32_t i = 0; i < 4; ++i)
+	{
+		EXPECT_TRUE(ring->Push(i));
+	}
+	EXPECT_FALSE(ring->Push(4));
+	EXPECT_EQ(ring->Num(), 4u);
+
+	std::vector<int32_t> drained;
+	EXPECT_EQ(ring->Drain([&drained](int32_t item) { drained.push_back(item); }), 4u);
+	EXPECT_EQ(drained, (std::vector<int32_t>{ 0, 1, 2, 3 }));
+	EXPECT_EQ(ring->Num(), 0u);
+
+	// Room is freed by the drain, the next pushes wrap around
+	EXPECT_TRUE(ring->Push(5));
+	EXPECT_TRUE(ring->Push(6));
+
+	drained.clear();
+	EXPECT_EQ(ring->Drain([&drained](int32_t item) { drained.push_back(item); }), 2u);
+	EXPECT_EQ(drained, (std::vector<int32_t>{ 5, 6 }));
+}
+
+// -----------------------------------------------------------------------------------------
+TEST(RingCore, ConsumerSeesEveryPushFromAnotherThread)
+{
+	constexpr int32_t NumItems = 50000;
+	std::unique_ptr<TSpscRing<int32_t, 64>> ring = std::make_unique<TSpscRing<int32_t, 64>>();
+
+	std::thread producer([&ring]()
+	{
+		for (int32_t i = 0; i < NumItems; ++i)
+		{
+			while (!ring->Push(i))
+			{
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int32_t expected = 0;
+	bool inOrder = true;
+	while (expected < NumItems)
+	{
+		const uint32_t numDrained = ring->Drain([&expected, &inOrder](int32_t item)
+		{
+			inOrder &= (item == expected);
+			++expected;
+		});
+
+		if (numDrained == 0)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+	EXPECT_TRUE(inOrder);
+	EXPECT_EQ(ring->Num(), 0u);
+}
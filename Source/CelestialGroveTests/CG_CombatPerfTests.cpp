@@ -0,0 +1,74 @@
+// ============================================================
+// FILE: CG_CombatPerfTests.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_PerfTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CG_SpellBase.h"
+#include "CG_CombatCommandSubsystem.h"
+
+#define COMBAT_PERF_EXTENT 5000.0f
+
+global const int32 GCombatPerfCounts[] = { 1, 100, 10000 };
+
+// -----------------------------------------------------------------------------------------
+// One op is a single ApplyDamageToTargets plus the flush that delivers it, so every target's
+// handler (or damage delegate) is called once per op.
+internal void RunDamagePerf(FAutomationTestBase & test, bool useCombatants)
+{
+	for (int32 count : GCombatPerfCounts)
+	{
+		FCG_PerfTestWorld world;
+		FRandomStream random(1337);
+
+		UCG_SpellBase * spell = NewObject<UCG_SpellBase>(world.GetWorld());
+		TArray<ESpellComponentType> components = { ESpellComponentType::FIRE_EFFECT, ESpellComponentType::RADIUS_TARGETING };
+		spell->BuildSpellFromTypes(components);
+
+		for (int32 i = 0; i < count; ++i)
+		{
+			const FVector location(random.FRandRange(-COMBAT_PERF_EXTENT, COMBAT_PERF_EXTENT), random.FRandRange(-COMBAT_PERF_EXTENT, COMBAT_PERF_EXTENT), 0.0f);
+			const FCG_TargetHandle handle = useCombatants ? world.AddCombatant(location, 50.0f) : world.AddTarget(location, 50.0f);
+			spell->AddTarget(handle, FVector::ForwardVector);
+		}
+
+		UCG_CombatCommandSubsystem * commands = world.GetWorld()->GetSubsystem<UCG_CombatCommandSubsystem>();
+		FCG_PerfResult result = MeasurePerf(1, [&]()
+		{
+			spell->ApplyDamageToTargets(1);
+			commands->Flush();
+		});
+
+		// Warmup call included
+		test.TestEqual(TEXT("Every target heard about every hit"), world.GetNumEvents(), (result.Ops + 1) * count);
+
+		const TCHAR * name = useCombatants ? TEXT("ApplyDamageToTargets, combatant handlers") : TEXT("ApplyDamageToTargets, damage delegates");
+		ReportPerf(test, FString::Printf(TEXT("%s, %d targets (%.1f ns/target)"), name, count, result.NsPerOp / count), result);
+	}
+}
+
+// ============================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCG_ApplyDamageCombatantsPerfTest, "CelestialGrove.Perf.Combat.ApplyDamageToCombatants", CG_PERF_TEST_FLAGS)
+
+// -----------------------------------------------------------------------------------------
+bool FCG_ApplyDamageCombatantsPerfTest::RunTest(const FString & parameters)
+{
+	RunDamagePerf(*this, true);
+	return true;
+}
+
+// ============================================================
+// Targets without combat state, damage goes out through each one's multicast delegate
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCG_ApplyDamageDelegatesPerfTest, "CelestialGrove.Perf.Combat.ApplyDamageToDelegates", CG_PERF_TEST_FLAGS)
+
+// -----------------------------------------------------------------------------------------
+bool FCG_ApplyDamageDelegatesPerfTest::RunTest(const FString & parameters)
+{
+	RunDamagePerf(*this, false);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,242 @@
+// ============================================================
+// FILE: CG_PerfTestUtils.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_PerfTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/Actor.h"
+#include "UObject/UObjectGlobals.h"
+#include "CG_CombatStateSubsystem.h"
+
+// ============================================================
+// Forwards everything to the allocator it replaced, counting the allocations made on one thread.
+// NOTE(RyanC): Only sees what goes through GMalloc. Platforms that compile a fixed allocator class
+// straight into FMemory will always read zero.
+class FCG_CountingMalloc final : public FMalloc
+{
+public:
+// ============================================================
+	virtual void * Malloc(SIZE_T count, uint32 alignment) override
+	{
+		CountAllocation();
+		return Inner->Malloc(count, alignment);
+	}
+
+	virtual void * TryMalloc(SIZE_T count, uint32 alignment) override
+	{
+		CountAllocation();
+		return Inner->TryMalloc(count, alignment);
+	}
+
+	// Growing an allocation is as good as making a new one
+	virtual void * Realloc(void * original, SIZE_T count, uint32 alignment) override
+	{
+		if (count > 0)
+		{
+			CountAllocation();
+		}
+		return Inner->Realloc(original, count, alignment);
+	}
+
+	virtual void * TryRealloc(void * original, SIZE_T count, uint32 alignment) override
+	{
+		if (count > 0)
+		{
+			CountAllocation();
+		}
+		return Inner->TryRealloc(original, count, alignment);
+	}
+
+	virtual void Free(void * original) override
+	{
+		Inner->Free(original);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override
+	{
+		return Inner->QuantizeSize(count, alignment);
+	}
+
+	virtual bool GetAllocationSize(void * original, SIZE_T & sizeOut) override
+	{
+		return Inner->GetAllocationSize(original, sizeOut);
+	}
+
+	virtual void Trim(bool trimThreadCaches) override
+	{
+		Inner->Trim(trimThreadCaches);
+	}
+
+	virtual void SetupTLSCachesOnCurrentThread() override
+	{
+		Inner->SetupTLSCachesOnCurrentThread();
+	}
+
+	virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+	{
+		Inner->ClearAndDisableTLSCachesOnCurrentThread();
+	}
+
+	virtual void UpdateStats() override
+	{
+		Inner->UpdateStats();
+	}
+
+	virtual void GetAllocatorStats(FGenericMemoryStats & outStats) override
+	{
+		Inner->GetAllocatorStats(outStats);
+	}
+
+	virtual void DumpAllocatorStats(FOutputDevice & output) override
+	{
+		Inner->DumpAllocatorStats(output);
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return Inner->IsInternallyThreadSafe();
+	}
+
+	virtual bool ValidateHeap() override
+	{
+		return Inner->ValidateHeap();
+	}
+
+	virtual const TCHAR * GetDescriptiveName() override
+	{
+		return Inner->GetDescriptiveName();
+	}
+
+// ============================================================
+	FMalloc * Inner = nullptr;
+	uint32 ThreadId = 0;
+	int64 Count = 0;
+
+private:
+// ============================================================
+	FORCEINLINE void CountAllocation()
+	{
+		if (FPlatformTLS::GetCurrentThreadId() == ThreadId)
+		{
+			++Count;
+		}
+	}
+};
+
+// NOTE(RyanC): Never destroyed, another thread can still be inside it just after it's swapped back out.
+global FCG_CountingMalloc GCountingMalloc;
+
+// -----------------------------------------------------------------------------------------
+FCG_ScopedAllocationCounter::FCG_ScopedAllocationCounter()
+{
+	check(GMalloc != &GCountingMalloc);
+
+	GCountingMalloc.Inner = GMalloc;
+	GCountingMalloc.ThreadId = FPlatformTLS::GetCurrentThreadId();
+	GCountingMalloc.Count = 0;
+	GMalloc = &GCountingMalloc;
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_ScopedAllocationCounter::~FCG_ScopedAllocationCounter()
+{
+	GMalloc = GCountingMalloc.Inner;
+}
+
+// -----------------------------------------------------------------------------------------
+int64 FCG_ScopedAllocationCounter::GetCount() const
+{
+	return GCountingMalloc.Count;
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_PerfTestWorld::FCG_PerfTestWorld()
+{
+	NumEvents = 0;
+
+	World = UWorld::CreateWorld(EWorldType::Game, false);
+	check(World);
+
+	FWorldContext & context = GEngine->CreateNewWorldContext(EWorldType::Game);
+	context.SetCurrentWorld(World);
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_PerfTestWorld::~FCG_PerfTestWorld()
+{
+	// Subsystems go with the world, the targets they pointed at are freed after
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	World = nullptr;
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_TargetHandle FCG_PerfTestWorld::AddCombatant(const FVector & location, float radius)
+{
+	FCG_SpellTarget * target = nullptr;
+	AActor * actor = SpawnTargetActor(location, radius, target);
+
+	UCG_TargetRegistrySubsystem * registry = World->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	FCG_TargetHandle handle = registry->RegisterTarget(actor, target, ESpellTargetKind::ANIMATE, Cast<UPrimitiveComponent>(actor->GetRootComponent()));
+
+	FCG_Stats stats;
+	stats.Health = MAX_int32;
+
+	World->GetSubsystem<UCG_CombatStateSubsystem>()->RegisterCombatant(handle, stats, FCG_CombatEventDelegate::CreateLambda([this](ECombatEvent, int32, uint8)
+	{
+		++NumEvents;
+	}));
+
+	return handle;
+}
+
+// -----------------------------------------------------------------------------------------
+FCG_TargetHandle FCG_PerfTestWorld::AddTarget(const FVector & location, float radius)
+{
+	FCG_SpellTarget * target = nullptr;
+	AActor * actor = SpawnTargetActor(location, radius, target);
+
+	target->ApplyDamageDelegate.AddLambda([this](int32)
+	{
+		++NumEvents;
+	});
+
+	UCG_TargetRegistrySubsystem * registry = World->GetSubsystem<UCG_TargetRegistrySubsystem>();
+	return registry->RegisterTarget(actor, target, ESpellTargetKind::INANIMATE, Cast<UPrimitiveComponent>(actor->GetRootComponent()));
+}
+
+// -----------------------------------------------------------------------------------------
+AActor * FCG_PerfTestWorld::SpawnTargetActor(const FVector & location, float radius, FCG_SpellTarget *& target)
+{
+	AActor * actor = World->SpawnActor<AActor>();
+	check(actor);
+
+	USphereComponent * sphere = NewObject<USphereComponent>(actor);
+	sphere->InitSphereRadius(radius);
+	sphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	actor->SetRootComponent(sphere);
+	sphere->SetWorldLocation(location);
+	sphere->RegisterComponent();
+
+	target = Targets.Emplace_GetRef(MakeUnique<FCG_SpellTarget>()).Get();
+	target->OwningActor = actor;
+	return actor;
+}
+
+// -----------------------------------------------------------------------------------------
+void ReportPerf(FAutomationTestBase & test, const FString & name, const FCG_PerfResult & result)
+{
+	test.AddInfo(FString::Printf(TEXT("%s: %.1f ns/op, %.3f allocs/op (%lld ops)"), *name, result.NsPerOp, result.AllocsPerOp, result.Ops));
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,135 @@
+// ============================================================
+// FILE: CG_PerfTestUtils.h
+// AUTHOR: RyanC
+// ============================================================
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "CG_GlobalDefines.h"
+#include "CG_TargetRegistrySubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+class UWorld;
+
+// ============================================================
+// Micro benchmarks for Celestial Grove
+// ============================================================
+// Everything under CelestialGrove.Perf, run headless with
+//
+//   CelestialGrove -nullrhi -nosound -unattended -ExecCmds="Automation RunTests CelestialGrove.Perf; Quit"
+//
+// Each result is logged as an info line with ns/op and heap allocations/op. Allocations are the
+// ones made on the game thread while measuring, anything the engine does on other threads
+// at the same time doesn't count.
+#define CG_PERF_TEST_FLAGS (EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+// Every benchmark keeps calling its function until both of these are met
+#define CG_PERF_MIN_SECONDS 0.25
+#define CG_PERF_MIN_CALLS 8
+
+// ============================================================
+struct FCG_PerfResult
+{
+	int64 Ops = 0;
+	double NsPerOp = 0.0;
+	double AllocsPerOp = 0.0;
+};
+
+// ============================================================
+// Counts heap allocations made on the thread that created it for as long as it's alive. Swaps
+// GMalloc for a proxy that forwards everything to the real one, so only one at a time.
+class FCG_ScopedAllocationCounter
+{
+public:
+// ============================================================
+	FCG_ScopedAllocationCounter();
+	~FCG_ScopedAllocationCounter();
+
+	int64 GetCount() const;
+};
+
+// ============================================================
+// A throwaway game world with the Celestial Grove subsystems in it. Targets are bare actors with
+// a sphere for bounds, registered straight with the target registry and combat state.
+class FCG_PerfTestWorld
+{
+public:
+// ============================================================
+	FCG_PerfTestWorld();
+	~FCG_PerfTestWorld();
+
+	// Handlers are bound to every combat event, health is high enough that nothing ever dies
+	FCG_TargetHandle AddCombatant(const FVector & location, float radius);
+
+	// No combat state, damage only goes through the target's damage delegate
+	FCG_TargetHandle AddTarget(const FVector & location, float radius);
+
+	FORCEINLINE UWorld * GetWorld() const;
+	FORCEINLINE int64 GetNumEvents() const;
+
+private:
+// ============================================================
+	AActor * SpawnTargetActor(const FVector & location, float radius, FCG_SpellTarget *& target);
+
+// ============================================================
+	UWorld * World;
+
+	// Registered by address, they can't move
+	TArray<TUniquePtr<FCG_SpellTarget>> Targets;
+
+	int64 NumEvents;
+};
+
+// -----------------------------------------------------------------------------------------
+// Calls the function once to warm up, then over and over while timing. opsPerCall is how many of
+// whatever is being measured the function does each time it's called.
+template <typename FunctionType>
+FCG_PerfResult MeasurePerf(int64 opsPerCall, FunctionType && function)
+{
+	function();
+
+	int64 calls = 0;
+	uint64 cycles = 0;
+	int64 allocations = 0;
+	{
+		FCG_ScopedAllocationCounter counter;
+		const uint64 startCycles = FPlatformTime::Cycles64();
+
+		do
+		{
+			function();
+			++calls;
+			cycles = FPlatformTime::Cycles64() - startCycles;
+		}
+		while (calls < CG_PERF_MIN_CALLS || FPlatformTime::ToSeconds64(cycles) < CG_PERF_MIN_SECONDS);
+
+		allocations = counter.GetCount();
+	}
+
+	FCG_PerfResult result;
+	result.Ops = calls * opsPerCall;
+	result.NsPerOp = (FPlatformTime::ToSeconds64(cycles) * 1.0e9) / result.Ops;
+	result.AllocsPerOp = (double)allocations / result.Ops;
+	return result;
+}
+
+void ReportPerf(FAutomationTestBase & test, const FString & name, const FCG_PerfResult & result);
+
+// ============================================================
+// INLINED FUNCTIONS
+// -----------------------------------------------------------------------------------------
+FORCEINLINE UWorld * FCG_PerfTestWorld::GetWorld() const
+{
+	return World;
+}
+// -----------------------------------------------------------------------------------------
+FORCEINLINE int64 FCG_PerfTestWorld::GetNumEvents() const
+{
+	return NumEvents;
+}
+// ============================================================
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,159 @@
+// ============================================================
+// FILE: CG_SpellPerfTests.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_PerfTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CG_SpellBase.h"
+#include "CG_CompiledSpell.h"
+#include "CG_SpellComponentRegistry.h"
+
+// -----------------------------------------------------------------------------------------
+// Every set of registered components with at least one targeting and one effect component, each
+// component at most once. Effects go first so one of them is the base.
+internal void GetComponentCombinations(TArray<TArray<FCG_SpellComponent>> & combinations)
+{
+	const UCG_SpellComponentRegistry * registry = UCG_SpellComponentRegistry::Get();
+	check(registry);
+
+	for (int32 mask = 1; mask < (1 << SPELL_COMPONENT_TYPE_COUNT); ++mask)
+	{
+		bool isRegistered = true;
+		uint32 categoryMask = 0;
+		for (int32 type = 0; type < SPELL_COMPONENT_TYPE_COUNT; ++type)
+		{
+			if ((mask & (1 << type)) == 0)
+			{
+				continue;
+			}
+
+			isRegistered &= registry->IsRegistered((ESpellComponentType)type);
+			SET_FLAG(categoryMask, (uint32)(1 << (int32)registry->GetStats((ESpellComponentType)type).Category));
+		}
+
+		const uint32 required = (1 << (int32)ESpellComponentCategory::TARGETING) | (1 << (int32)ESpellComponentCategory::EFFECT);
+		if (!isRegistered || !COMPARE_FLAG(categoryMask, required))
+		{
+			continue;
+		}
+
+		TArray<FCG_SpellComponent> & components = combinations.Emplace_GetRef();
+		for (int32 pass = 0; pass < 2; ++pass)
+		{
+			for (int32 type = 0; type < SPELL_COMPONENT_TYPE_COUNT; ++type)
+			{
+				const bool isEffect = registry->GetStats((ESpellComponentType)type).Category == ESpellComponentCategory::EFFECT;
+				if ((mask & (1 << type)) != 0 && isEffect == (pass == 0))
+				{
+					components.Emplace(registry->GetComponentRow((ESpellComponentType)type));
+				}
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------------------
+internal void BuildSpells(UWorld * world, TArray<TArray<FCG_SpellComponent>> & combinations, TArray<UCG_SpellBase *> & spells)
+{
+	for (TArray<FCG_SpellComponent> & components : combinations)
+	{
+		UCG_SpellBase * spell = NewObject<UCG_SpellBase>(world);
+		spell->BuildSpell(components);
+		spells.Emplace(spell);
+	}
+}
+
+// ============================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCG_BuildSpellPerfTest, "CelestialGrove.Perf.Spells.BuildSpell", CG_PERF_TEST_FLAGS)
+
+// -----------------------------------------------------------------------------------------
+bool FCG_BuildSpellPerfTest::RunTest(const FString & parameters)
+{
+	TArray<TArray<FCG_SpellComponent>> combinations;
+	GetComponentCombinations(combinations);
+	if (combinations.Num() == 0)
+	{
+		AddError(TEXT("No component combinations to build, is the spell component table loading?"));
+		return false;
+	}
+
+	FCG_PerfTestWorld world;
+	TArray<UCG_SpellBase *> spells;
+	BuildSpells(world.GetWorld(), combinations, spells);
+
+	// Every spell is still holding its compiled spell, so this is the cache lookup
+	FCG_PerfResult cached = MeasurePerf(combinations.Num(), [&]()
+	{
+		for (int32 i = 0; i < spells.Num(); ++i)
+		{
+			spells[i]->BuildSpell(combinations[i]);
+		}
+	});
+
+	// Dropping the cache first has every one of them compile again
+	FCG_PerfResult compiled = MeasurePerf(combinations.Num(), [&]()
+	{
+		FCG_CompiledSpell::ResetCache();
+		for (int32 i = 0; i < spells.Num(); ++i)
+		{
+			spells[i]->BuildSpell(combinations[i]);
+		}
+	});
+
+	ReportPerf(*this, FString::Printf(TEXT("BuildSpell cached, %d combinations"), combinations.Num()), cached);
+	ReportPerf(*this, FString::Printf(TEXT("BuildSpell compiling, %d combinations"), combinations.Num()), compiled);
+	return true;
+}
+
+// ============================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCG_HasComponentsInCategoryPerfTest, "CelestialGrove.Perf.Spells.HasComponentsInCategory", CG_PERF_TEST_FLAGS)
+
+// -----------------------------------------------------------------------------------------
+bool FCG_HasComponentsInCategoryPerfTest::RunTest(const FString & parameters)
+{
+	TArray<TArray<FCG_SpellComponent>> combinations;
+	GetComponentCombinations(combinations);
+	if (combinations.Num() == 0)
+	{
+		AddError(TEXT("No component combinations to build, is the spell component table loading?"));
+		return false;
+	}
+
+	FCG_PerfTestWorld world;
+	TArray<UCG_SpellBase *> spells;
+	BuildSpells(world.GetWorld(), combinations, spells);
+
+	// Asked the same way blueprints do, one query per component type against its own category
+	const UCG_SpellComponentRegistry * registry = UCG_SpellComponentRegistry::Get();
+	TArray<ESpellComponentCategory> categories;
+	TArray<TArray<ESpellComponentType>> types;
+	for (int32 type = 0; type < SPELL_COMPONENT_TYPE_COUNT; ++type)
+	{
+		if (registry->IsRegistered((ESpellComponentType)type))
+		{
+			categories.Emplace(registry->GetStats((ESpellComponentType)type).Category);
+			types.Emplace_GetRef().Emplace((ESpellComponentType)type);
+		}
+	}
+
+	int64 matches = 0;
+	FCG_PerfResult result = MeasurePerf(spells.Num() * types.Num(), [&]()
+	{
+		for (UCG_SpellBase * spell : spells)
+		{
+			for (int32 i = 0; i < types.Num(); ++i)
+			{
+				matches += spell->HasComponentsInCategory(categories[i], types[i]) ? 1 : 0;
+			}
+		}
+	});
+
+	TestTrue(TEXT("Some spells have the components asked for"), matches > 0);
+	ReportPerf(*this, FString::Printf(TEXT("HasComponentsInCategory, %d spells x %d types"), spells.Num(), types.Num()), result);
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,98 @@
+// ============================================================
+// FILE: CG_TargetingPerfTests.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CG_PerfTestUtils.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "CG_TargetFilter.h"
+
+// Candidates are scattered through a box this wide around the query origin
+#define TARGETING_PERF_EXTENT 5000.0f
+#define TARGETING_PERF_RADIUS 2000.0f
+#define TARGETING_PERF_CONE_ANGLE 30.0f
+
+global const int32 GTargetingPerfCounts[] = { 1, 100, 10000 };
+
+// -----------------------------------------------------------------------------------------
+internal void MakeCandidates(int32 count, FCG_TargetCandidates & candidates)
+{
+	FRandomStream random(1337);
+
+	candidates.Reset();
+	for (int32 i = 0; i < count; ++i)
+	{
+		const FVector location(random.FRandRange(-TARGETING_PERF_EXTENT, TARGETING_PERF_EXTENT),
+			random.FRandRange(-TARGETING_PERF_EXTENT, TARGETING_PERF_EXTENT),
+			random.FRandRange(-200.0f, 200.0f));
+
+		candidates.Add(location, random.FRandRange(30.0f, 100.0f), i);
+	}
+
+	candidates.Pad();
+}
+
+// -----------------------------------------------------------------------------------------
+// Filtering compacts the candidates in place, this puts them back without touching the allocator
+internal void RestoreCandidates(const FCG_TargetCandidates & source, FCG_TargetCandidates & candidates)
+{
+	const int32 padded = source.X.Num();
+	FMemory::Memcpy(candidates.X.GetData(), source.X.GetData(), padded * sizeof(float));
+	FMemory::Memcpy(candidates.Y.GetData(), source.Y.GetData(), padded * sizeof(float));
+	FMemory::Memcpy(candidates.Z.GetData(), source.Z.GetData(), padded * sizeof(float));
+	FMemory::Memcpy(candidates.Radius.GetData(), source.Radius.GetData(), padded * sizeof(float));
+	FMemory::Memcpy(candidates.Index.GetData(), source.Index.GetData(), padded * sizeof(int32));
+	candidates.Num = source.Num;
+}
+
+// -----------------------------------------------------------------------------------------
+// One op is one query over every candidate, putting the candidates back in is part of it the
+// same way the registry gathers them fresh for every query.
+internal void RunFilterPerf(FAutomationTestBase & test, const TCHAR * name, float cosAngle)
+{
+	FCG_TargetFilterQuery query;
+	query.Origin = FVector3f::ZeroVector;
+	query.Forward = FVector3f::ForwardVector;
+	query.Radius = TARGETING_PERF_RADIUS;
+	query.CosAngle = cosAngle;
+
+	for (int32 count : GTargetingPerfCounts)
+	{
+		FCG_TargetCandidates source;
+		MakeCandidates(count, source);
+		FCG_TargetCandidates candidates = source;
+
+		int64 kept = 0;
+		FCG_PerfResult result = MeasurePerf(1, [&]()
+		{
+			RestoreCandidates(source, candidates);
+			kept += FilterTargetCandidates(query, candidates);
+		});
+
+		ReportPerf(test, FString::Printf(TEXT("%s, %d candidates (%.1f ns/candidate)"), name, count, result.NsPerOp / count), result);
+	}
+}
+
+// ============================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCG_SphereFilterPerfTest, "CelestialGrove.Perf.Targeting.SphereFilter", CG_PERF_TEST_FLAGS)
+
+// -----------------------------------------------------------------------------------------
+bool FCG_SphereFilterPerfTest::RunTest(const FString & parameters)
+{
+	RunFilterPerf(*this, TEXT("Sphere filter"), -1.0f);
+	return true;
+}
+
+// ============================================================
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCG_ConeFilterPerfTest, "CelestialGrove.Perf.Targeting.ConeFilter", CG_PERF_TEST_FLAGS)
+
+// -----------------------------------------------------------------------------------------
+bool FCG_ConeFilterPerfTest::RunTest(const FString & parameters)
+{
+	RunFilterPerf(*this, TEXT("Cone filter"), FMath::Cos(FMath::DegreesToRadians(TARGETING_PERF_CONE_ANGLE)));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
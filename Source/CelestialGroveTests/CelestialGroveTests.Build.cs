@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class CelestialGroveTests : ModuleRules
+{
+	public CelestialGroveTests(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PrivateDependencyModuleNames.AddRange(new string[] {
+															"Core",
+															"CoreUObject",
+															"Engine",
+															"CelestialGrove"
+														});
+
+		PrivateIncludePaths.AddRange(new string[] {
+													"./CelestialGroveTests"
+												  });
+	}
+}
@@ -0,0 +1,11 @@
+// ============================================================
+// FILE: CelestialGroveTests.cpp
+// AUTHOR: RyanC
+// ============================================================
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+// NOTE(RyanC): Nothing to start up, the module only exists so the automation tests in it get
+// registered. Everything in here compiles out along with WITH_DEV_AUTOMATION_TESTS.
+IMPLEMENT_MODULE(FDefaultModuleImpl, CelestialGroveTests);